@@ -1,62 +1,995 @@
 #pragma once
 
-#include <queue>
-#include <unordered_map>
+#include "GridLocation.h"
+#include "OpenList.h"
+#include "PathSmoothing.h"
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <cmath>
+#include <climits>
+#include <cassert>
+#include <chrono>
+#include <bit>
+#include <algorithm>
 
 class Grid;
 
-struct GridLocation
+enum class eSearchMode
+{
+	// Expands every walkable neighbor, the directions and costs come from the policy
+	Neighbors,
+
+	// Jump point search, eight directions without cutting corners, uniform cost
+	JumpPoint,
+
+	// Jump point search on jump distances precomputed by BuildJumpDistances
+	JumpPointPlus,
+
+	// Neighbors searched from the start and the goal at once, stops once no meeting of the two can be cheaper than the best one found
+	Bidirectional,
+
+	// Theta*, eight directions where a cell takes its parent's parent when it can see it, GetPath returns the corners only
+	AnyAngle,
+};
+
+enum class eSearchStatus
 {
-	GridLocation() : x(), y() {}
-	GridLocation(int aX, int aY) : x(aX), y(aY) {}
+	Idle,
+	InProgress,
+	Found,
+	NoPath,
+};
 
-	bool operator==(const GridLocation& aOtherGridLocation) const
+// Search state of one cell, only valid while generation matches the search that wrote it
+struct AStarNode
+{
+	int gCost;
+	int parent;
+	uint32_t generation;
+};
+
+/*
+	Cost policies for AStar. GetCost is the cost of a step from aFrom to the neighbor aTo and GetHeuristic
+	may never overestimate the cost that is left. Both are static so the search loop inlines them.
+*/
+struct UniformCostPolicy
+{
+	// Four directions, every step costs one
+	static constexpr bool ourDiagonal = false;
+
+	template<class SearchGrid>
+	static int GetCost(SearchGrid&, const GridLocation&, const GridLocation&)
 	{
-		return x == aOtherGridLocation.x && y == aOtherGridLocation.y;
+		return 1;
 	}
 
-	int x;
-	int y;
-
-	struct HashFunction
+	static int GetHeuristic(const GridLocation& aLocation, const GridLocation& aGoalLocation)
 	{
-		size_t operator()(const GridLocation& aGridLocation) const noexcept
-		{
-			return aGridLocation.x + INT_MAX * aGridLocation.y;
-		}
-	};
+		return std::abs(aLocation.x - aGoalLocation.x) + std::abs(aLocation.y - aGoalLocation.y);
+	}
 };
 
-struct CellCost
+struct DiagonalCostPolicy
 {
-	int gCost;
-	int hCost;
+	// Eight directions without cutting corners
+	static constexpr bool ourDiagonal = true;
 
-	GridLocation location;
+	static constexpr int ourStraightCost = 10;
+	static constexpr int ourDiagonalCost = 14;
 
-	int Cost() const
+	template<class SearchGrid>
+	static int GetCost(SearchGrid&, const GridLocation& aFrom, const GridLocation& aTo)
 	{
-		return gCost + hCost;
+		return aFrom.x != aTo.x && aFrom.y != aTo.y ? ourDiagonalCost : ourStraightCost;
 	}
 
-	bool operator<(const CellCost& other) const
+	/* Octile */
+	static int GetHeuristic(const GridLocation& aLocation, const GridLocation& aGoalLocation)
 	{
-		return Cost() > other.Cost(); // For priority queue (min-heap)
+		const int dx = std::abs(aLocation.x - aGoalLocation.x);
+		const int dy = std::abs(aLocation.y - aGoalLocation.y);
+
+		return ourStraightCost * std::max(dx, dy) + (ourDiagonalCost - ourStraightCost) * std::min(dx, dy);
 	}
 };
 
+struct TerrainCostPolicy
+{
+	// Eight directions, a step costs the diagonal policy's cost times the cost of the cell it ends on, which has to be at least one
+	static constexpr bool ourDiagonal = true;
 
-class AStar 
+	template<class SearchGrid>
+	static int GetCost(SearchGrid& aSearchGrid, const GridLocation& aFrom, const GridLocation& aTo)
+	{
+		return DiagonalCostPolicy::GetCost(aSearchGrid, aFrom, aTo) * static_cast<int>(aSearchGrid.GetCell(aTo).cost);
+	}
+
+	static int GetHeuristic(const GridLocation& aLocation, const GridLocation& aGoalLocation)
+	{
+		return DiagonalCostPolicy::GetHeuristic(aLocation, aGoalLocation);
+	}
+};
+
+
+/*
+	Cell state is kept in a flat array indexed by y * width + x that lives between searches.
+	Every search bumps the generation instead of clearing the array, so a search only touches the cells it reaches.
+	The jump point modes only put jump points in the open list and fill in the cells between them when the path is built.
+	Policy sets the step costs and the heuristic of the Neighbors and Bidirectional modes, the jump point modes always use DiagonalCostPolicy
+	and AnyAngle uses straight line distances in the same units.
+	The backward half of a bidirectional search has its own cells and open list that share the generation of the forward ones.
+	OpenList is one of the open lists in OpenList.h. SearchGrid can be a NavigationGrid, whose neighbor masks replace GetNeighbors.
+*/
+template<class Policy = UniformCostPolicy, class SearchGrid = Grid, class OpenList = BinaryHeapOpenList>
+class AStar
 {
 
 	public:
-		std::vector<GridLocation> FindPath(Grid& aSearchGrid, GridLocation aStartLocation, GridLocation aGoalLocation);
+		// The path goes from the goal back to the first step after the start, so the next step is at the back.
+		// Returns an empty path when there is no path or the start is the goal.
+		// In AnyAngle mode consecutive cells of the path can be far apart, any two can see each other.
+		std::vector<GridLocation> FindPath(SearchGrid& aSearchGrid, GridLocation aStartLocation, GridLocation aGoalLocation);
+
+		// Resumable search, the open list and costs are kept between calls to Step until the next StartSearch or FindPath.
+		// The grid must not change while the search is in progress.
+		void StartSearch(SearchGrid& aSearchGrid, GridLocation aStartLocation, GridLocation aGoalLocation);
+
+		// Expands at most aMaxExpansions cells or until aMaxTime has passed, whichever comes first
+		eSearchStatus Step(const int aMaxExpansions, const std::chrono::microseconds aMaxTime = std::chrono::microseconds::max());
+
+		// The path once found, before that the path to the expanded cell closest to the goal, same shape as FindPath
+		std::vector<GridLocation> GetPath() const;
+
+		inline eSearchStatus GetSearchStatus() const { return mySearchStatus; }
+
+		inline void SetSearchMode(const eSearchMode aSearchMode) { mySearchMode = aSearchMode; }
+		inline eSearchMode GetSearchMode() const { return mySearchMode; }
+
+		// Precomputes the jump distances used by eSearchMode::JumpPointPlus, has to be called again when walkability changes
+		void BuildJumpDistances(SearchGrid& aSearchGrid);
+
+		// Number of cells taken from the open list by the last search
+		inline int GetExpandedCount() const { return myExpandedCount; }
+
+		// Most entries an open list held during the last search, stale ones included
+		inline size_t GetPeakOpenListSize() const { return myPeakOpenListSize; }
 
 	private:
+		// Cost of a straight and a diagonal step in the jump point modes
+		static constexpr int ourStraightCost = DiagonalCostPolicy::ourStraightCost;
+		static constexpr int ourDiagonalCost = DiagonalCostPolicy::ourDiagonalCost;
+
+		// Eight directions clockwise from north, diagonals have odd indices
+		static constexpr int ourDirectionX[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+		static constexpr int ourDirectionY[8] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+
+		// Expands the next cell of the open list, false once the search is over
+		bool ExpandNext();
+		bool ExpandNextBidirectional();
+
+		void ExpandNeighbors(const CellCost& aCurrent, const int aCurrentIndex);
+		void ExpandBidirectional(const CellCost& aCurrent, const int aCurrentIndex, const bool aForward);
+		void ExpandJumpPoint(const CellCost& aCurrent, const int aCurrentIndex);
+		void ExpandJumpPointPlus(const CellCost& aCurrent, const int aCurrentIndex);
+		void ExpandAnyAngle(const CellCost& aCurrent, const int aCurrentIndex);
+
+		// Directions a jump point search continues in from the cell, counted clockwise from the first
+		void GetSearchDirections(const GridLocation& aLocation, const int aIndex, int& outFirstDirection, int& outDirectionCount) const;
+
+		// Index into the direction tables of a step of -1, 0 or 1 on each axis, not both 0
+		static int GetDirection(const int aDirectionX, const int aDirectionY);
+
+		// Walks from aLocation in the direction until it finds a jump point or the goal, returns its index or -1
+		int Jump(SearchGrid& aSearchGrid, GridLocation aLocation, const int aDirectionX, const int aDirectionY, const GridLocation& aGoalLocation);
 
-		/* Manhattan */
-		int Heuristic(GridLocation& aLocation, GridLocation& aSecondLocation);
+		// Whether a step in the direction from aLocation stays on walkable cells without cutting a corner
+		bool CanStep(SearchGrid& aSearchGrid, const GridLocation& aLocation, const int aDirectionX, const int aDirectionY);
 
-		std::vector<GridLocation> BuildPath(std::unordered_map<GridLocation, GridLocation, GridLocation::HashFunction> aSearchedPath, GridLocation aGoalLocation);
+		// Whether arriving at aLocation by a straight step in the direction leaves a neighbor that can only be reached through it
+		bool HasForcedNeighbor(SearchGrid& aSearchGrid, const GridLocation& aLocation, const int aDirectionX, const int aDirectionY);
+
+		bool IsWalkable(SearchGrid& aSearchGrid, const int aX, const int aY);
+
+		// Calls aVisit with every cell the policy can step to from aLocation
+		template<class Visitor>
+		void VisitNeighbors(const GridLocation& aLocation, Visitor&& aVisit);
+
+		// Updates the cell if aGCost is better than what this search has seen and adds it to the open list, false when it was not better
+		bool Relax(std::vector<AStarNode>& someNodes, OpenList& aOpenList, const GridLocation& aLocation, const int aGCost, const int aHCost, const int aParent);
+		inline void Relax(const GridLocation& aLocation, const int aGCost, const int aHCost, const int aParent) { Relax(myNodes, myOpenList, aLocation, aGCost, aHCost, aParent); }
+
+		// Takes the cheapest entry from the open list, false when it is empty
+		bool PopFrontier(std::vector<AStarNode>& someNodes, OpenList& aOpenList, CellCost& outCurrent);
+		inline bool PopFrontier(CellCost& outCurrent) { return PopFrontier(myNodes, myOpenList, outCurrent); }
+
+		// Keeps the cell as the meeting point when both halves of a bidirectional search have reached it and the path through it is the cheapest yet
+		void UpdateMeeting(const int aIndex);
+
+		/* Octile */
+		static int OctileDistance(const GridLocation& aLocation, const GridLocation& aSecondLocation);
+
+		// Rounded down for the heuristic so it never overestimates
+		static int EuclideanDistance(const GridLocation& aLocation, const GridLocation& aSecondLocation, const bool aRoundDown = false);
+
+		// Makes room for a grid of the given size and starts a new generation
+		void BeginSearch(const int aWidth, const int aHeight);
+
+		inline int GetIndex(const GridLocation& aLocation) const { return aLocation.y * myWidth + aLocation.x; }
+		inline GridLocation GetLocation(const int aIndex) const { return GridLocation(aIndex % myWidth, aIndex / myWidth); }
+
+		std::vector<GridLocation> BuildPath(const int aGoalIndex) const;
+
+		// Only the cells the parents point at, for paths whose parents are not in a straight or diagonal line
+		std::vector<GridLocation> BuildWaypoints(const int aGoalIndex) const;
+
+	private:
+		std::vector<AStarNode> myNodes;
+		OpenList myOpenList;
+
+		// Costs from the goal, only sized once a bidirectional search has run
+		std::vector<AStarNode> myBackwardNodes;
+		OpenList myBackwardOpenList;
+
+		// Generation in which each half of a bidirectional search expanded the cell
+		std::vector<uint32_t> myForwardExpanded;
+		std::vector<uint32_t> myBackwardExpanded;
+
+		// Eight distances per cell, positive to the next jump point and zero or negative to the last cell before a wall
+		std::vector<int> myJumpDistances;
+		int myJumpDistancesWidth = 0;
+		int myJumpDistancesHeight = 0;
+
+		eSearchMode mySearchMode = eSearchMode::Neighbors;
+
+		// State of the search started by StartSearch
+		SearchGrid* mySearchGrid = nullptr;
+		GridLocation myStartLocation;
+		GridLocation myGoalLocation;
+		eSearchStatus mySearchStatus = eSearchStatus::Idle;
+		int myBestIndex = -1;
+		int myBestHCost = INT_MAX;
+
+		// Cheapest path through a cell reached by both halves of a bidirectional search
+		int myMeetingIndex = -1;
+		int myBestPathCost = INT_MAX;
+
+		int myWidth = 0;
+		int myHeight = 0;
+		int myExpandedCount = 0;
+		size_t myPeakOpenListSize = 0;
+
+		uint32_t myGeneration = 0;
 
 };
+
+template<class Policy, class SearchGrid, class OpenList>
+inline std::vector<GridLocation> AStar<Policy, SearchGrid, OpenList>::FindPath(SearchGrid& aSearchGrid, GridLocation aStartLocation, GridLocation aGoalLocation)
+{
+	StartSearch(aSearchGrid, aStartLocation, aGoalLocation);
+
+	if (Step(INT_MAX) != eSearchStatus::Found)
+	{
+		// No Path
+		return {};
+	}
+
+	return GetPath();
+}
+
+template<class Policy, class SearchGrid, class OpenList>
+inline void AStar<Policy, SearchGrid, OpenList>::StartSearch(SearchGrid& aSearchGrid, GridLocation aStartLocation, GridLocation aGoalLocation)
+{
+	assert((mySearchMode != eSearchMode::JumpPointPlus || (myJumpDistancesWidth == aSearchGrid.GetWidth() && myJumpDistancesHeight == aSearchGrid.GetHeight())) &&
+		"BuildJumpDistances has not been called for this grid");
+
+	BeginSearch(aSearchGrid.GetWidth(), aSearchGrid.GetHeight());
+
+	mySearchGrid = &aSearchGrid;
+	myStartLocation = aStartLocation;
+	myGoalLocation = aGoalLocation;
+	mySearchStatus = eSearchStatus::InProgress;
+	myMeetingIndex = -1;
+	myBestPathCost = INT_MAX;
+
+	const bool jumpPoint = mySearchMode == eSearchMode::JumpPoint || mySearchMode == eSearchMode::JumpPointPlus;
+
+	int hCost = jumpPoint ? OctileDistance(aStartLocation, aGoalLocation) : Policy::GetHeuristic(aStartLocation, aGoalLocation);
+	if (mySearchMode == eSearchMode::AnyAngle)
+	{
+		hCost = EuclideanDistance(aStartLocation, aGoalLocation, true);
+	}
+
+	Relax(aStartLocation, 0, hCost, -1);
+
+	myBestIndex = GetIndex(aStartLocation);
+	myBestHCost = hCost;
+
+	if (mySearchMode == eSearchMode::Bidirectional)
+	{
+		Relax(myBackwardNodes, myBackwardOpenList, aGoalLocation, 0, hCost, -1);
+		UpdateMeeting(GetIndex(aGoalLocation));
+	}
+}
+
+template<class Policy, class SearchGrid, class OpenList>
+inline eSearchStatus AStar<Policy, SearchGrid, OpenList>::Step(const int aMaxExpansions, const std::chrono::microseconds aMaxTime)
+{
+	if (mySearchStatus != eSearchStatus::InProgress)
+	{
+		return mySearchStatus;
+	}
+
+	// The clock is only read every few expansions, one expansion is far cheaper than reading it
+	constexpr int timeCheckInterval = 16;
+
+	const bool timed = aMaxTime != std::chrono::microseconds::max();
+	const std::chrono::steady_clock::time_point deadline = timed ? std::chrono::steady_clock::now() + aMaxTime : std::chrono::steady_clock::time_point::max();
+
+	const bool bidirectional = mySearchMode == eSearchMode::Bidirectional;
+
+	for (int expansion = 0; expansion < aMaxExpansions; ++expansion)
+	{
+		if (timed && expansion % timeCheckInterval == timeCheckInterval - 1 && std::chrono::steady_clock::now() >= deadline)
+		{
+			break;
+		}
+
+		if (!(bidirectional ? ExpandNextBidirectional() : ExpandNext()))
+		{
+			break;
+		}
+	}
+
+	return mySearchStatus;
+}
+
+template<class Policy, class SearchGrid, class OpenList>
+inline std::vector<GridLocation> AStar<Policy, SearchGrid, OpenList>::GetPath() const
+{
+	if (mySearchStatus == eSearchStatus::Idle)
+	{
+		return {};
+	}
+
+	if (mySearchMode == eSearchMode::AnyAngle)
+	{
+		return BuildWaypoints(myBestIndex);
+	}
+
+	if (mySearchStatus != eSearchStatus::Found || myMeetingIndex == -1)
+	{
+		return BuildPath(myBestIndex);
+	}
+
+	// The backward half from the goal to the meeting point, then the forward half from there
+	std::vector<GridLocation> path;
+	for (int index = myBackwardNodes[myMeetingIndex].parent; index != -1; index = myBackwardNodes[index].parent)
+	{
+		path.push_back(GetLocation(index));
+	}
+
+	std::reverse(path.begin(), path.end());
+
+	const std::vector<GridLocation> forwardPath = BuildPath(myMeetingIndex);
+	path.insert(path.end(), forwardPath.begin(), forwardPath.end());
+
+	return path;
+}
+
+template<class Policy, class SearchGrid, class OpenList>
+inline void AStar<Policy, SearchGrid, OpenList>::BuildJumpDistances(SearchGrid& aSearchGrid)
+{
+	const int width = aSearchGrid.GetWidth();
+	const int height = aSearchGrid.GetHeight();
+
+	// IsWalkable checks bounds against the search size
+	myWidth = width;
+	myHeight = height;
+
+	myJumpDistancesWidth = width;
+	myJumpDistancesHeight = height;
+	myJumpDistances.assign(static_cast<size_t>(width) * height * 8, 0);
+
+	auto distance = [&](const int aX, const int aY, const int aDirection) -> int&
+	{
+		return myJumpDistances[(static_cast<size_t>(aY) * width + aX) * 8 + aDirection];
+	};
+
+	// Straight directions first since the diagonals stop where a straight scan finds a jump point.
+	// Cells are visited from the far end of the direction so the next cell is always done before the current one.
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		for (int direction = pass; direction < 8; direction += 2)
+		{
+			const int dx = ourDirectionX[direction];
+			const int dy = ourDirectionY[direction];
+
+			for (int row = 0; row < height; ++row)
+			{
+				const int y = dy > 0 ? height - 1 - row : row;
+
+				for (int column = 0; column < width; ++column)
+				{
+					const int x = dx > 0 ? width - 1 - column : column;
+					if (!IsWalkable(aSearchGrid, x, y))
+					{
+						continue;
+					}
+
+					const GridLocation location(x, y);
+					const GridLocation next(x + dx, y + dy);
+
+					int& jumpDistance = distance(x, y, direction);
+
+					if (!CanStep(aSearchGrid, location, dx, dy))
+					{
+						jumpDistance = 0;
+					}
+					else if (pass == 0 ? HasForcedNeighbor(aSearchGrid, next, dx, dy) :
+						distance(next.x, next.y, direction - 1) > 0 || distance(next.x, next.y, (direction + 1) % 8) > 0)
+					{
+						jumpDistance = 1;
+					}
+					else
+					{
+						const int nextDistance = distance(next.x, next.y, direction);
+						jumpDistance = nextDistance > 0 ? nextDistance + 1 : nextDistance - 1;
+					}
+				}
+			}
+		}
+	}
+}
+
+template<class Policy, class SearchGrid, class OpenList>
+inline bool AStar<Policy, SearchGrid, OpenList>::ExpandNext()
+{
+	CellCost current;
+	if (!PopFrontier(current))
+	{
+		mySearchStatus = eSearchStatus::NoPath;
+		return false;
+	}
+
+	const int currentIndex = GetIndex(current.location);
+
+	if (current.location == myGoalLocation)
+	{
+		myBestIndex = currentIndex;
+		myBestHCost = 0;
+		mySearchStatus = eSearchStatus::Found;
+		return false;
+	}
+
+	if (current.hCost < myBestHCost)
+	{
+		myBestIndex = currentIndex;
+		myBestHCost = current.hCost;
+	}
+
+	switch (mySearchMode)
+	{
+		case eSearchMode::JumpPoint:
+		{
+			ExpandJumpPoint(current, currentIndex);
+			break;
+		}
+		case eSearchMode::JumpPointPlus:
+		{
+			ExpandJumpPointPlus(current, currentIndex);
+			break;
+		}
+		case eSearchMode::AnyAngle:
+		{
+			ExpandAnyAngle(current, currentIndex);
+			break;
+		}
+		default:
+		{
+			ExpandNeighbors(current, currentIndex);
+			break;
+		}
+	}
+
+	return true;
+}
+
+template<class Policy, class SearchGrid, class OpenList>
+inline bool AStar<Policy, SearchGrid, OpenList>::ExpandNextBidirectional()
+{
+	// The half with the smaller open list goes next, which keeps the two frontiers about the same size
+	const bool forward = myOpenList.Size() <= myBackwardOpenList.Size();
+
+	CellCost current;
+	if (!PopFrontier(forward ? myNodes : myBackwardNodes, forward ? myOpenList : myBackwardOpenList, current))
+	{
+		// One half has reached everything it can, so every meeting has been seen
+		mySearchStatus = myMeetingIndex != -1 ? eSearchStatus::Found : eSearchStatus::NoPath;
+		return false;
+	}
+
+	// The cheapest total cost in either open list is a lower bound on every path not found yet
+	if (current.Cost() >= myBestPathCost)
+	{
+		mySearchStatus = eSearchStatus::Found;
+		return false;
+	}
+
+	const int currentIndex = GetIndex(current.location);
+
+	if (forward && current.hCost < myBestHCost)
+	{
+		myBestIndex = currentIndex;
+		myBestHCost = current.hCost;
+	}
+
+	(forward ? myForwardExpanded : myBackwardExpanded)[currentIndex] = myGeneration;
+
+	// Both halves have the final cost of the cell, so the cheapest path through it is already a meeting and going on from it finds nothing new
+	if ((forward ? myBackwardExpanded : myForwardExpanded)[currentIndex] == myGeneration)
+	{
+		return true;
+	}
+
+	ExpandBidirectional(current, currentIndex, forward);
+	return true;
+}
+
+template<class Policy, class SearchGrid, class OpenList>
+inline void AStar<Policy, SearchGrid, OpenList>::ExpandNeighbors(const CellCost& aCurrent, const int aCurrentIndex)
+{
+	SearchGrid& searchGrid = *mySearchGrid;
+
+	VisitNeighbors(aCurrent.location, [&](const GridLocation& aNext)
+	{
+		Relax(aNext, aCurrent.gCost + Policy::GetCost(searchGrid, aCurrent.location, aNext), Policy::GetHeuristic(aNext, myGoalLocation), aCurrentIndex);
+	});
+}
+
+template<class Policy, class SearchGrid, class OpenList>
+inline void AStar<Policy, SearchGrid, OpenList>::ExpandBidirectional(const CellCost& aCurrent, const int aCurrentIndex, const bool aForward)
+{
+	SearchGrid& searchGrid = *mySearchGrid;
+
+	std::vector<AStarNode>& nodes = aForward ? myNodes : myBackwardNodes;
+	OpenList& openList = aForward ? myOpenList : myBackwardOpenList;
+	const GridLocation& target = aForward ? myGoalLocation : myStartLocation;
+
+	VisitNeighbors(aCurrent.location, [&](const GridLocation& aNext)
+	{
+		// The backward half walks the steps the other way, so it pays for the step from aNext into the current cell
+		const int stepCost = aForward ? Policy::GetCost(searchGrid, aCurrent.location, aNext) : Policy::GetCost(searchGrid, aNext, aCurrent.location);
+
+		if (Relax(nodes, openList, aNext, aCurrent.gCost + stepCost, Policy::GetHeuristic(aNext, target), aCurrentIndex))
+		{
+			UpdateMeeting(GetIndex(aNext));
+		}
+	});
+}
+
+template<class Policy, class SearchGrid, class OpenList>
+inline void AStar<Policy, SearchGrid, OpenList>::ExpandJumpPoint(const CellCost& aCurrent, const int aCurrentIndex)
+{
+	SearchGrid& searchGrid = *mySearchGrid;
+
+	int firstDirection;
+	int directionCount;
+	GetSearchDirections(aCurrent.location, aCurrentIndex, firstDirection, directionCount);
+
+	for (int i = 0; i < directionCount; ++i)
+	{
+		const int direction = (firstDirection + i) % 8;
+		const int dx = ourDirectionX[direction];
+		const int dy = ourDirectionY[direction];
+
+		if (!CanStep(searchGrid, aCurrent.location, dx, dy))
+		{
+			continue;
+		}
+
+		const int jumpPoint = Jump(searchGrid, GridLocation(aCurrent.location.x + dx, aCurrent.location.y + dy), dx, dy, myGoalLocation);
+		if (jumpPoint == -1)
+		{
+			continue;
+		}
+
+		const GridLocation jumpLocation = GetLocation(jumpPoint);
+		Relax(jumpLocation, aCurrent.gCost + OctileDistance(aCurrent.location, jumpLocation), OctileDistance(jumpLocation, myGoalLocation), aCurrentIndex);
+	}
+}
+
+template<class Policy, class SearchGrid, class OpenList>
+inline void AStar<Policy, SearchGrid, OpenList>::ExpandJumpPointPlus(const CellCost& aCurrent, const int aCurrentIndex)
+{
+	int firstDirection;
+	int directionCount;
+	GetSearchDirections(aCurrent.location, aCurrentIndex, firstDirection, directionCount);
+
+	const int goalX = myGoalLocation.x - aCurrent.location.x;
+	const int goalY = myGoalLocation.y - aCurrent.location.y;
+
+	for (int i = 0; i < directionCount; ++i)
+	{
+		const int direction = (firstDirection + i) % 8;
+		const int dx = ourDirectionX[direction];
+		const int dy = ourDirectionY[direction];
+
+		const int jumpDistance = myJumpDistances[static_cast<size_t>(aCurrentIndex) * 8 + direction];
+		const int reach = std::abs(jumpDistance);
+
+		int steps = jumpDistance > 0 ? jumpDistance : 0;
+
+		if (direction % 2 == 0)
+		{
+			// The goal is on this line before the next jump point or wall
+			const bool onLine = dx == 0 ? goalX == 0 && goalY * dy > 0 : goalY == 0 && goalX * dx > 0;
+			if (onLine && std::abs(goalX + goalY) <= reach)
+			{
+				steps = std::abs(goalX + goalY);
+			}
+		}
+		else
+		{
+			// The goal's row or column is crossed before the next jump point or wall, stop there and go straight
+			const bool inQuadrant = goalX * dx > 0 && goalY * dy > 0;
+			if (inQuadrant && (std::abs(goalX) <= reach || std::abs(goalY) <= reach))
+			{
+				steps = std::min(std::abs(goalX), std::abs(goalY));
+			}
+		}
+
+		if (steps == 0)
+		{
+			continue;
+		}
+
+		const GridLocation next(aCurrent.location.x + dx * steps, aCurrent.location.y + dy * steps);
+		const int stepCost = direction % 2 == 0 ? ourStraightCost : ourDiagonalCost;
+
+		Relax(next, aCurrent.gCost + stepCost * steps, OctileDistance(next, myGoalLocation), aCurrentIndex);
+	}
+}
+
+template<class Policy, class SearchGrid, class OpenList>
+inline void AStar<Policy, SearchGrid, OpenList>::ExpandAnyAngle(const CellCost& aCurrent, const int aCurrentIndex)
+{
+	SearchGrid& searchGrid = *mySearchGrid;
+
+	const int parent = myNodes[aCurrentIndex].parent;
+	const GridLocation parentLocation = parent != -1 ? GetLocation(parent) : GridLocation();
+
+	for (int direction = 0; direction < 8; ++direction)
+	{
+		const int dx = ourDirectionX[direction];
+		const int dy = ourDirectionY[direction];
+
+		if (!CanStep(searchGrid, aCurrent.location, dx, dy))
+		{
+			continue;
+		}
+
+		const GridLocation next(aCurrent.location.x + dx, aCurrent.location.y + dy);
+		const int hCost = EuclideanDistance(next, myGoalLocation, true);
+
+		// A straight line from the parent is never longer than going through the current cell
+		if (parent != -1 && PathSmoothing::HasLineOfSight(searchGrid, parentLocation, next))
+		{
+			Relax(next, myNodes[parent].gCost + EuclideanDistance(parentLocation, next), hCost, parent);
+		}
+		else
+		{
+			Relax(next, aCurrent.gCost + EuclideanDistance(aCurrent.location, next), hCost, aCurrentIndex);
+		}
+	}
+}
+
+template<class Policy, class SearchGrid, class OpenList>
+inline void AStar<Policy, SearchGrid, OpenList>::GetSearchDirections(const GridLocation& aLocation, const int aIndex, int& outFirstDirection, int& outDirectionCount) const
+{
+	// All eight for the start
+	outFirstDirection = 0;
+	outDirectionCount = 8;
+
+	const int parent = myNodes[aIndex].parent;
+	if (parent == -1)
+	{
+		return;
+	}
+
+	const GridLocation parentLocation = GetLocation(parent);
+	const int dx = (aLocation.x > parentLocation.x) - (aLocation.x < parentLocation.x);
+	const int dy = (aLocation.y > parentLocation.y) - (aLocation.y < parentLocation.y);
+
+	const int direction = GetDirection(dx, dy);
+
+	// Straight moves turn to both sides, diagonal moves only continue along their two components
+	outDirectionCount = direction % 2 == 0 ? 5 : 3;
+	outFirstDirection = direction + 8 - outDirectionCount / 2;
+}
+
+template<class Policy, class SearchGrid, class OpenList>
+inline int AStar<Policy, SearchGrid, OpenList>::GetDirection(const int aDirectionX, const int aDirectionY)
+{
+	int direction = 0;
+	while (ourDirectionX[direction] != aDirectionX || ourDirectionY[direction] != aDirectionY)
+	{
+		++direction;
+	}
+
+	return direction;
+}
+
+template<class Policy, class SearchGrid, class OpenList>
+inline int AStar<Policy, SearchGrid, OpenList>::Jump(SearchGrid& aSearchGrid, GridLocation aLocation, const int aDirectionX, const int aDirectionY, const GridLocation& aGoalLocation)
+{
+	for (;;)
+	{
+		if (aLocation == aGoalLocation)
+		{
+			return GetIndex(aLocation);
+		}
+
+		if (aDirectionX != 0 && aDirectionY != 0)
+		{
+			// A diagonal cell is a jump point when one of its straight components finds one
+			const bool horizontal = CanStep(aSearchGrid, aLocation, aDirectionX, 0) &&
+				Jump(aSearchGrid, GridLocation(aLocation.x + aDirectionX, aLocation.y), aDirectionX, 0, aGoalLocation) != -1;
+
+			const bool vertical = !horizontal && CanStep(aSearchGrid, aLocation, 0, aDirectionY) &&
+				Jump(aSearchGrid, GridLocation(aLocation.x, aLocation.y + aDirectionY), 0, aDirectionY, aGoalLocation) != -1;
+
+			if (horizontal || vertical)
+			{
+				return GetIndex(aLocation);
+			}
+		}
+		else if (HasForcedNeighbor(aSearchGrid, aLocation, aDirectionX, aDirectionY))
+		{
+			return GetIndex(aLocation);
+		}
+
+		if (!CanStep(aSearchGrid, aLocation, aDirectionX, aDirectionY))
+		{
+			return -1;
+		}
+
+		aLocation.x += aDirectionX;
+		aLocation.y += aDirectionY;
+	}
+}
+
+template<class Policy, class SearchGrid, class OpenList>
+inline bool AStar<Policy, SearchGrid, OpenList>::CanStep(SearchGrid& aSearchGrid, const GridLocation& aLocation, const int aDirectionX, const int aDirectionY)
+{
+	if (!IsWalkable(aSearchGrid, aLocation.x + aDirectionX, aLocation.y + aDirectionY))
+	{
+		return false;
+	}
+
+	return aDirectionX == 0 || aDirectionY == 0 ||
+		(IsWalkable(aSearchGrid, aLocation.x + aDirectionX, aLocation.y) && IsWalkable(aSearchGrid, aLocation.x, aLocation.y + aDirectionY));
+}
+
+template<class Policy, class SearchGrid, class OpenList>
+inline bool AStar<Policy, SearchGrid, OpenList>::HasForcedNeighbor(SearchGrid& aSearchGrid, const GridLocation& aLocation, const int aDirectionX, const int aDirectionY)
+{
+	const int x = aLocation.x;
+	const int y = aLocation.y;
+
+	if (aDirectionX != 0)
+	{
+		return (IsWalkable(aSearchGrid, x, y - 1) && !IsWalkable(aSearchGrid, x - aDirectionX, y - 1)) ||
+			   (IsWalkable(aSearchGrid, x, y + 1) && !IsWalkable(aSearchGrid, x - aDirectionX, y + 1));
+	}
+
+	return (IsWalkable(aSearchGrid, x - 1, y) && !IsWalkable(aSearchGrid, x - 1, y - aDirectionY)) ||
+		   (IsWalkable(aSearchGrid, x + 1, y) && !IsWalkable(aSearchGrid, x + 1, y - aDirectionY));
+}
+
+template<class Policy, class SearchGrid, class OpenList>
+inline bool AStar<Policy, SearchGrid, OpenList>::IsWalkable(SearchGrid& aSearchGrid, const int aX, const int aY)
+{
+	if (aX < 0 || aY < 0 || aX >= myWidth || aY >= myHeight)
+	{
+		return false;
+	}
+
+	return aSearchGrid.GetCell(GridLocation(aX, aY)).walkable;
+}
+
+template<class Policy, class SearchGrid, class OpenList>
+template<class Visitor>
+inline void AStar<Policy, SearchGrid, OpenList>::VisitNeighbors(const GridLocation& aLocation, Visitor&& aVisit)
+{
+	SearchGrid& searchGrid = *mySearchGrid;
+
+	if constexpr (requires { searchGrid.GetNeighborMask(aLocation); })
+	{
+		// Grids like NavigationGrid give every step at once without allocating, in the same direction order as the tables here
+		uint32_t mask = searchGrid.GetNeighborMask(aLocation);
+		if constexpr (!Policy::ourDiagonal)
+		{
+			mask &= 0x55;
+		}
+
+		for (; mask != 0; mask &= mask - 1)
+		{
+			const int direction = std::countr_zero(mask);
+			aVisit(GridLocation(aLocation.x + ourDirectionX[direction], aLocation.y + ourDirectionY[direction]));
+		}
+	}
+	else if constexpr (Policy::ourDiagonal)
+	{
+		for (int direction = 0; direction < 8; ++direction)
+		{
+			const int dx = ourDirectionX[direction];
+			const int dy = ourDirectionY[direction];
+
+			if (CanStep(searchGrid, aLocation, dx, dy))
+			{
+				aVisit(GridLocation(aLocation.x + dx, aLocation.y + dy));
+			}
+		}
+	}
+	else
+	{
+		for (auto& next : searchGrid.GetNeighbors(aLocation))
+		{
+			if (searchGrid.GetCell(next).walkable)
+			{
+				aVisit(next);
+			}
+		}
+	}
+}
+
+template<class Policy, class SearchGrid, class OpenList>
+inline bool AStar<Policy, SearchGrid, OpenList>::Relax(std::vector<AStarNode>& someNodes, OpenList& aOpenList, const GridLocation& aLocation, const int aGCost, const int aHCost, const int aParent)
+{
+	const int index = GetIndex(aLocation);
+
+	AStarNode& node = someNodes[index];
+	if (node.generation == myGeneration && node.gCost <= aGCost)
+	{
+		return false;
+	}
+
+	node = { aGCost, aParent, myGeneration };
+
+	aOpenList.Push(CellCost{ aGCost, aHCost, aLocation }, index);
+	return true;
+}
+
+template<class Policy, class SearchGrid, class OpenList>
+inline bool AStar<Policy, SearchGrid, OpenList>::PopFrontier(std::vector<AStarNode>& someNodes, OpenList& aOpenList, CellCost& outCurrent)
+{
+	myPeakOpenListSize = std::max(myPeakOpenListSize, aOpenList.Size());
+
+	while (aOpenList.Pop(outCurrent))
+	{
+		// Entries left behind when a cell got cheaper are skipped, only BinaryHeapOpenList has them
+		if (outCurrent.gCost == someNodes[GetIndex(outCurrent.location)].gCost)
+		{
+			++myExpandedCount;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+template<class Policy, class SearchGrid, class OpenList>
+inline void AStar<Policy, SearchGrid, OpenList>::UpdateMeeting(const int aIndex)
+{
+	const AStarNode& forward = myNodes[aIndex];
+	const AStarNode& backward = myBackwardNodes[aIndex];
+
+	if (forward.generation != myGeneration || backward.generation != myGeneration)
+	{
+		return;
+	}
+
+	if (forward.gCost + backward.gCost < myBestPathCost)
+	{
+		myBestPathCost = forward.gCost + backward.gCost;
+		myMeetingIndex = aIndex;
+	}
+}
+
+template<class Policy, class SearchGrid, class OpenList>
+inline void AStar<Policy, SearchGrid, OpenList>::BeginSearch(const int aWidth, const int aHeight)
+{
+	myWidth = aWidth;
+	myHeight = aHeight;
+	myExpandedCount = 0;
+	myPeakOpenListSize = 0;
+
+	const size_t cellCount = static_cast<size_t>(aWidth) * aHeight;
+	if (myNodes.size() < cellCount)
+	{
+		myNodes.resize(cellCount, { 0, -1, 0 });
+	}
+
+	const bool bidirectional = mySearchMode == eSearchMode::Bidirectional;
+	if (bidirectional && myBackwardNodes.size() < cellCount)
+	{
+		myBackwardNodes.resize(cellCount, { 0, -1, 0 });
+		myForwardExpanded.resize(cellCount, 0);
+		myBackwardExpanded.resize(cellCount, 0);
+	}
+
+	// Generation 0 marks cells that were never reached, after a wrap every cell is reset once
+	++myGeneration;
+	if (myGeneration == 0)
+	{
+		std::fill(myNodes.begin(), myNodes.end(), AStarNode{ 0, -1, 0 });
+		std::fill(myBackwardNodes.begin(), myBackwardNodes.end(), AStarNode{ 0, -1, 0 });
+		std::fill(myForwardExpanded.begin(), myForwardExpanded.end(), 0);
+		std::fill(myBackwardExpanded.begin(), myBackwardExpanded.end(), 0);
+		myGeneration = 1;
+	}
+
+	myOpenList.Clear(cellCount);
+
+	if (bidirectional)
+	{
+		myBackwardOpenList.Clear(cellCount);
+	}
+}
+
+template<class Policy, class SearchGrid, class OpenList>
+inline std::vector<GridLocation> AStar<Policy, SearchGrid, OpenList>::BuildPath(const int aGoalIndex) const
+{
+	std::vector<GridLocation> path;
+
+	// Parents can be several cells away in a straight or diagonal line, the cells between are filled in
+	for (int index = aGoalIndex; myNodes[index].parent != -1; index = myNodes[index].parent)
+	{
+		GridLocation location = GetLocation(index);
+		const GridLocation parent = GetLocation(myNodes[index].parent);
+
+		const int dx = (parent.x > location.x) - (parent.x < location.x);
+		const int dy = (parent.y > location.y) - (parent.y < location.y);
+
+		while (!(location == parent))
+		{
+			path.push_back(location);
+			location.x += dx;
+			location.y += dy;
+		}
+	}
+
+	return path;
+}
+
+template<class Policy, class SearchGrid, class OpenList>
+inline std::vector<GridLocation> AStar<Policy, SearchGrid, OpenList>::BuildWaypoints(const int aGoalIndex) const
+{
+	std::vector<GridLocation> path;
+
+	for (int index = aGoalIndex; myNodes[index].parent != -1; index = myNodes[index].parent)
+	{
+		path.push_back(GetLocation(index));
+	}
+
+	return path;
+}
+
+template<class Policy, class SearchGrid, class OpenList>
+inline int AStar<Policy, SearchGrid, OpenList>::OctileDistance(const GridLocation& aLocation, const GridLocation& aSecondLocation)
+{
+	return DiagonalCostPolicy::GetHeuristic(aLocation, aSecondLocation);
+}
+
+template<class Policy, class SearchGrid, class OpenList>
+inline int AStar<Policy, SearchGrid, OpenList>::EuclideanDistance(const GridLocation& aLocation, const GridLocation& aSecondLocation, const bool aRoundDown)
+{
+	const double dx = aLocation.x - aSecondLocation.x;
+	const double dy = aLocation.y - aSecondLocation.y;
+	const double distance = ourStraightCost * std::sqrt(dx * dx + dy * dy);
+
+	return static_cast<int>(aRoundDown ? distance : std::round(distance));
+}
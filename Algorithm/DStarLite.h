@@ -0,0 +1,465 @@
+#pragma once
+
+#include "AStar.h"
+
+#include <vector>
+#include <cstdint>
+#include <climits>
+#include <cassert>
+#include <algorithm>
+
+class Grid;
+
+
+/*
+	D* Lite: an incremental planner that searches from the goal back to the start and keeps its costs between plans.
+	When cells change only the costs that depend on them are repaired, and moving the start keeps the costs too,
+	so an agent that replans after every small edit redoes a fraction of a full AStar search.
+	Each agent keeps its own planner, with three ints per cell of the grid.
+	Steps and costs come from the same policies as AStar, cells that can not be walked have no steps in or out.
+*/
+template<class Policy = UniformCostPolicy, class SearchGrid = Grid>
+class DStarLite
+{
+
+	public:
+		// Plans from scratch, the grid is kept until the next Initialize and has to outlive the planner
+		void Initialize(SearchGrid& aSearchGrid, GridLocation aStartLocation, GridLocation aGoalLocation);
+
+		// Where the agent is now, the costs to the goal stay valid
+		void SetStartLocation(const GridLocation& aLocation);
+
+		// Call after the walkability or cost of a cell has changed, the plan is repaired by the next FindPath
+		void MarkCellChanged(const GridLocation& aLocation);
+
+		// Same path shape as AStar::FindPath, from the goal back to the first step after the start, empty when there is no path
+		std::vector<GridLocation> FindPath();
+
+		inline const GridLocation& GetStartLocation() const { return myStartLocation; }
+		inline const GridLocation& GetGoalLocation() const { return myGoalLocation; }
+
+		// Number of cells taken from the open list since Initialize or the last FindPath
+		inline int GetExpandedCount() const { return myExpandedCount; }
+
+	private:
+		// Larger than any path and still safe to add a step to
+		static constexpr int ourInfinity = INT_MAX / 4;
+
+		static constexpr int ourDirectionX[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+		static constexpr int ourDirectionY[8] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+
+		// Straight directions only, or all eight
+		static constexpr int ourDirectionStep = Policy::ourDiagonal ? 1 : 2;
+
+		struct Node
+		{
+			// Cost to the goal as of the last expansion, and the one step lookahead of it
+			int gCost;
+			int rhsCost;
+
+			// Bumped whenever the cell is pushed or leaves the open list, so older entries are skipped
+			uint32_t stamp;
+		};
+
+		struct Key
+		{
+			int first;
+			int second;
+
+			bool operator<(const Key& other) const
+			{
+				return first < other.first || (first == other.first && second < other.second);
+			}
+		};
+
+		struct Entry
+		{
+			Key key;
+			int index;
+			uint32_t stamp;
+
+			bool operator<(const Entry& other) const
+			{
+				return other.key < key; // For the heap (min-heap)
+			}
+		};
+
+		void ComputeShortestPath();
+
+		// Applies the cells marked since the last plan
+		void RepairChangedCells();
+
+		// Recomputes the lookahead of the cell from its neighbors and puts it in the open list when it is inconsistent
+		void UpdateCell(const int aIndex);
+		void UpdateOpenList(const int aIndex);
+
+		Key CalculateKey(const int aIndex) const;
+
+		// Takes stale entries off the top of the open list, false when it is empty
+		bool PeekFrontier(Entry& outTop);
+		void Push(const int aIndex);
+
+		// Cost of a step from the cell to the neighbor in the direction, ourInfinity when it can not be taken
+		int GetStepCost(const int aIndex, const int aDirection) const;
+		bool IsWalkable(const int aX, const int aY) const;
+
+		inline int GetIndex(const GridLocation& aLocation) const { return aLocation.y * myWidth + aLocation.x; }
+		inline GridLocation GetLocation(const int aIndex) const { return GridLocation(aIndex % myWidth, aIndex / myWidth); }
+
+		inline static int Add(const int aCost, const int aOtherCost) { return std::min(aCost + aOtherCost, ourInfinity); }
+
+	private:
+		std::vector<Node> myNodes;
+		std::vector<Entry> myOpenList;
+		std::vector<GridLocation> myChangedCells;
+
+		SearchGrid* mySearchGrid = nullptr;
+		GridLocation myStartLocation;
+		GridLocation myGoalLocation;
+
+		// Start of the last plan, the keys in the open list are offset by how far the start has moved since Initialize
+		GridLocation myLastStartLocation;
+		int myKeyModifier = 0;
+
+		int myWidth = 0;
+		int myHeight = 0;
+		int myExpandedCount = 0;
+
+};
+
+template<class Policy, class SearchGrid>
+inline void DStarLite<Policy, SearchGrid>::Initialize(SearchGrid& aSearchGrid, GridLocation aStartLocation, GridLocation aGoalLocation)
+{
+	mySearchGrid = &aSearchGrid;
+	myWidth = aSearchGrid.GetWidth();
+	myHeight = aSearchGrid.GetHeight();
+
+	myStartLocation = aStartLocation;
+	myLastStartLocation = aStartLocation;
+	myGoalLocation = aGoalLocation;
+	myKeyModifier = 0;
+	myExpandedCount = 0;
+
+	myNodes.assign(static_cast<size_t>(myWidth) * myHeight, { ourInfinity, ourInfinity, 0 });
+	myOpenList.clear();
+	myChangedCells.clear();
+
+	const int goal = GetIndex(aGoalLocation);
+	myNodes[goal].rhsCost = IsWalkable(aGoalLocation.x, aGoalLocation.y) ? 0 : ourInfinity;
+	UpdateOpenList(goal);
+
+	ComputeShortestPath();
+}
+
+template<class Policy, class SearchGrid>
+inline void DStarLite<Policy, SearchGrid>::SetStartLocation(const GridLocation& aLocation)
+{
+	myStartLocation = aLocation;
+}
+
+template<class Policy, class SearchGrid>
+inline void DStarLite<Policy, SearchGrid>::MarkCellChanged(const GridLocation& aLocation)
+{
+	myChangedCells.push_back(aLocation);
+}
+
+template<class Policy, class SearchGrid>
+inline std::vector<GridLocation> DStarLite<Policy, SearchGrid>::FindPath()
+{
+	assert(mySearchGrid && "Initialize has not been called");
+
+	myExpandedCount = 0;
+
+	// Keys already in the open list stay lower bounds when every new key grows by the distance the start has moved,
+	// this has to happen whenever the start moved, also when no cell changed
+	myKeyModifier += Policy::GetHeuristic(myLastStartLocation, myStartLocation);
+	myLastStartLocation = myStartLocation;
+
+	if (!myChangedCells.empty())
+	{
+		RepairChangedCells();
+	}
+
+	ComputeShortestPath();
+
+	std::vector<GridLocation> path;
+
+	int current = GetIndex(myStartLocation);
+	if (myNodes[current].gCost >= ourInfinity)
+	{
+		// No Path
+		return path;
+	}
+
+	// Down the costs to the goal, a step is never longer than the cells in the grid
+	const int goal = GetIndex(myGoalLocation);
+	while (current != goal && path.size() < myNodes.size())
+	{
+		int bestCost = ourInfinity;
+		int bestDirection = -1;
+
+		for (int direction = 0; direction < 8; direction += ourDirectionStep)
+		{
+			const int stepCost = GetStepCost(current, direction);
+			if (stepCost >= ourInfinity)
+			{
+				continue;
+			}
+
+			const int next = current + ourDirectionY[direction] * myWidth + ourDirectionX[direction];
+			const int cost = Add(stepCost, myNodes[next].gCost);
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestDirection = direction;
+			}
+		}
+
+		if (bestDirection == -1)
+		{
+			return {};
+		}
+
+		current += ourDirectionY[bestDirection] * myWidth + ourDirectionX[bestDirection];
+		path.push_back(GetLocation(current));
+	}
+
+	// The costs lead around in a loop, a partial path would look like a real one
+	if (current != goal)
+	{
+		return {};
+	}
+
+	std::reverse(path.begin(), path.end());
+	return path;
+}
+
+template<class Policy, class SearchGrid>
+inline void DStarLite<Policy, SearchGrid>::ComputeShortestPath()
+{
+	const int start = GetIndex(myStartLocation);
+
+	Entry top;
+	while (PeekFrontier(top))
+	{
+		const Node& startNode = myNodes[start];
+		if (!(top.key < CalculateKey(start)) && startNode.rhsCost == startNode.gCost)
+		{
+			break;
+		}
+
+		std::pop_heap(myOpenList.begin(), myOpenList.end());
+		myOpenList.pop_back();
+		++myExpandedCount;
+
+		const int current = top.index;
+		Node& node = myNodes[current];
+
+		// The start has moved since the cell was pushed
+		const Key key = CalculateKey(current);
+		if (top.key < key)
+		{
+			Push(current);
+			continue;
+		}
+
+		if (node.gCost > node.rhsCost)
+		{
+			node.gCost = node.rhsCost;
+			++node.stamp;
+
+			// The cell got cheaper, so its neighbors can only get cheaper through it
+			for (int direction = 0; direction < 8; direction += ourDirectionStep)
+			{
+				const int stepCost = GetStepCost(current, direction);
+				if (stepCost >= ourInfinity)
+				{
+					continue;
+				}
+
+				// Steps are symmetric in walkability but not in cost, the neighbor pays for the step back into this cell
+				const int neighbor = current + ourDirectionY[direction] * myWidth + ourDirectionX[direction];
+				const int reverseDirection = (direction + 4) % 8;
+
+				Node& neighborNode = myNodes[neighbor];
+				const int cost = Add(GetStepCost(neighbor, reverseDirection), node.gCost);
+				if (cost < neighborNode.rhsCost)
+				{
+					neighborNode.rhsCost = cost;
+					UpdateOpenList(neighbor);
+				}
+			}
+		}
+		else
+		{
+			// The cell got more expensive, everything that went through it has to look again
+			const int oldCost = node.gCost;
+			node.gCost = ourInfinity;
+
+			for (int direction = 0; direction < 8; direction += ourDirectionStep)
+			{
+				if (GetStepCost(current, direction) >= ourInfinity)
+				{
+					continue;
+				}
+
+				const int neighbor = current + ourDirectionY[direction] * myWidth + ourDirectionX[direction];
+				if (myNodes[neighbor].rhsCost == Add(GetStepCost(neighbor, (direction + 4) % 8), oldCost))
+				{
+					UpdateCell(neighbor);
+				}
+			}
+
+			UpdateCell(current);
+		}
+	}
+}
+
+template<class Policy, class SearchGrid>
+inline void DStarLite<Policy, SearchGrid>::RepairChangedCells()
+{
+	for (const GridLocation& location : myChangedCells)
+	{
+		// The cell's own steps and the steps into it from the neighbors, including diagonals that pass its corner
+		for (int y = std::max(location.y - 1, 0); y <= std::min(location.y + 1, myHeight - 1); ++y)
+		{
+			for (int x = std::max(location.x - 1, 0); x <= std::min(location.x + 1, myWidth - 1); ++x)
+			{
+				UpdateCell(GetIndex(GridLocation(x, y)));
+			}
+		}
+	}
+
+	myChangedCells.clear();
+}
+
+template<class Policy, class SearchGrid>
+inline void DStarLite<Policy, SearchGrid>::UpdateCell(const int aIndex)
+{
+	if (aIndex == GetIndex(myGoalLocation))
+	{
+		const GridLocation goal = GetLocation(aIndex);
+		myNodes[aIndex].rhsCost = IsWalkable(goal.x, goal.y) ? 0 : ourInfinity;
+		UpdateOpenList(aIndex);
+		return;
+	}
+
+	int rhsCost = ourInfinity;
+	for (int direction = 0; direction < 8; direction += ourDirectionStep)
+	{
+		const int stepCost = GetStepCost(aIndex, direction);
+		if (stepCost >= ourInfinity)
+		{
+			continue;
+		}
+
+		const int next = aIndex + ourDirectionY[direction] * myWidth + ourDirectionX[direction];
+		rhsCost = std::min(rhsCost, Add(stepCost, myNodes[next].gCost));
+	}
+
+	myNodes[aIndex].rhsCost = rhsCost;
+	UpdateOpenList(aIndex);
+}
+
+template<class Policy, class SearchGrid>
+inline void DStarLite<Policy, SearchGrid>::UpdateOpenList(const int aIndex)
+{
+	Node& node = myNodes[aIndex];
+	if (node.gCost != node.rhsCost)
+	{
+		Push(aIndex);
+	}
+	else
+	{
+		++node.stamp;
+	}
+}
+
+template<class Policy, class SearchGrid>
+inline typename DStarLite<Policy, SearchGrid>::Key DStarLite<Policy, SearchGrid>::CalculateKey(const int aIndex) const
+{
+	const Node& node = myNodes[aIndex];
+	const int cost = std::min(node.gCost, node.rhsCost);
+
+	if (cost >= ourInfinity)
+	{
+		return { INT_MAX, ourInfinity };
+	}
+
+	return { cost + Policy::GetHeuristic(GetLocation(aIndex), myStartLocation) + myKeyModifier, cost };
+}
+
+template<class Policy, class SearchGrid>
+inline bool DStarLite<Policy, SearchGrid>::PeekFrontier(Entry& outTop)
+{
+	while (!myOpenList.empty())
+	{
+		outTop = myOpenList.front();
+
+		const Node& node = myNodes[outTop.index];
+		if (outTop.stamp == node.stamp && node.gCost != node.rhsCost)
+		{
+			return true;
+		}
+
+		std::pop_heap(myOpenList.begin(), myOpenList.end());
+		myOpenList.pop_back();
+	}
+
+	return false;
+}
+
+template<class Policy, class SearchGrid>
+inline void DStarLite<Policy, SearchGrid>::Push(const int aIndex)
+{
+	// A long lived planner leaves stale entries below the top, they are dropped once they outnumber the cells
+	if (myOpenList.size() > myNodes.size() * 2)
+	{
+		myOpenList.erase(std::remove_if(myOpenList.begin(), myOpenList.end(), [this](const Entry& aEntry)
+		{
+			const Node& node = myNodes[aEntry.index];
+			return aEntry.stamp != node.stamp || node.gCost == node.rhsCost;
+		}), myOpenList.end());
+
+		std::make_heap(myOpenList.begin(), myOpenList.end());
+	}
+
+	Node& node = myNodes[aIndex];
+	++node.stamp;
+
+	myOpenList.push_back({ CalculateKey(aIndex), aIndex, node.stamp });
+	std::push_heap(myOpenList.begin(), myOpenList.end());
+}
+
+template<class Policy, class SearchGrid>
+inline int DStarLite<Policy, SearchGrid>::GetStepCost(const int aIndex, const int aDirection) const
+{
+	const GridLocation location = GetLocation(aIndex);
+
+	const int dx = ourDirectionX[aDirection];
+	const int dy = ourDirectionY[aDirection];
+
+	if (!IsWalkable(location.x, location.y) || !IsWalkable(location.x + dx, location.y + dy))
+	{
+		return ourInfinity;
+	}
+
+	// No cutting corners
+	if (dx != 0 && dy != 0 && (!IsWalkable(location.x + dx, location.y) || !IsWalkable(location.x, location.y + dy)))
+	{
+		return ourInfinity;
+	}
+
+	return Policy::GetCost(*mySearchGrid, location, GridLocation(location.x + dx, location.y + dy));
+}
+
+template<class Policy, class SearchGrid>
+inline bool DStarLite<Policy, SearchGrid>::IsWalkable(const int aX, const int aY) const
+{
+	if (aX < 0 || aY < 0 || aX >= myWidth || aY >= myHeight)
+	{
+		return false;
+	}
+
+	return mySearchGrid->GetCell(GridLocation(aX, aY)).walkable;
+}
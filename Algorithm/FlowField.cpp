@@ -0,0 +1,219 @@
+#include "FlowField.h"
+
+#include <cassert>
+#include <algorithm>
+
+void FlowField::Build(Grid& aSearchGrid, const GridLocation& aGoalLocation)
+{
+	myWidth = aSearchGrid.GetWidth();
+	myHeight = aSearchGrid.GetHeight();
+	myStride = myWidth + 2;
+	myGoalLocation = aGoalLocation;
+
+	const size_t paddedCount = static_cast<size_t>(myStride) * (myHeight + 2);
+	myWalls.assign(paddedCount, ourUnreachable);
+	myCosts.assign(paddedCount, 0);
+	myMaxCost = 1;
+	myDistances.assign(paddedCount, ourUnreachable);
+
+	for (int y = 0; y < myHeight; ++y)
+	{
+		for (int x = 0; x < myWidth; ++x)
+		{
+			const auto& cell = aSearchGrid.GetCell(GridLocation(x, y));
+			if (cell.walkable)
+			{
+				assert(cell.cost >= 1 && "Cell costs have to be at least one");
+
+				myWalls[GetIndex(x, y)] = 0;
+				myCosts[GetIndex(x, y)] = static_cast<int>(cell.cost);
+				myMaxCost = std::max(myMaxCost, static_cast<int>(cell.cost));
+			}
+		}
+	}
+
+	BuildDistances();
+	BuildDirections();
+}
+
+GridLocation FlowField::GetStep(const GridLocation& aLocation) const
+{
+	const int direction = myDirections[aLocation.y * myWidth + aLocation.x];
+	if (direction == -1)
+	{
+		return GridLocation(0, 0);
+	}
+
+	return GridLocation(ourDirectionX[direction], ourDirectionY[direction]);
+}
+
+int FlowField::GetDistance(const GridLocation& aLocation) const
+{
+	const int distance = myDistances[GetIndex(aLocation.x, aLocation.y)];
+	return distance < ourUnreachable ? distance : -1;
+}
+
+void FlowField::BuildDistances()
+{
+	const int goal = GetIndex(myGoalLocation.x, myGoalLocation.y);
+	if (myWalls[goal] != 0)
+	{
+		return;
+	}
+
+	// A step costs more than zero and less than bucketCount, so a cell never goes into the bucket being emptied
+	const size_t bucketCount = static_cast<size_t>(DiagonalCostPolicy::ourDiagonalCost) * myMaxCost + 1;
+	myBuckets.resize(std::max(myBuckets.size(), bucketCount));
+	for (std::vector<int>& bucket : myBuckets)
+	{
+		bucket.clear();
+	}
+
+	myDistances[goal] = 0;
+	myBuckets[0].push_back(goal);
+	size_t queuedCount = 1;
+
+	for (int distance = 0; queuedCount > 0; ++distance)
+	{
+		std::vector<int>& bucket = myBuckets[distance % bucketCount];
+
+		for (const int current : bucket)
+		{
+			// Cells are queued again when they get closer, the older entries are skipped
+			if (myDistances[current] != distance)
+			{
+				continue;
+			}
+
+			// Searched from the goal, so a neighbor pays for stepping onto the current cell
+			const int stepCost = DiagonalCostPolicy::ourStraightCost * myCosts[current];
+			const int diagonalStepCost = DiagonalCostPolicy::ourDiagonalCost * myCosts[current];
+
+			for (int direction = 0; direction < 8; ++direction)
+			{
+				const int offsetX = ourDirectionX[direction];
+				const int offsetY = ourDirectionY[direction] * myStride;
+				const int next = current + offsetY + offsetX;
+
+				if (myWalls[next] != 0)
+				{
+					continue;
+				}
+
+				const bool diagonal = direction % 2 == 1;
+				if (diagonal && (myWalls[current + offsetX] != 0 || myWalls[current + offsetY] != 0))
+				{
+					continue;
+				}
+
+				const int nextDistance = distance + (diagonal ? diagonalStepCost : stepCost);
+				if (nextDistance < myDistances[next])
+				{
+					myDistances[next] = nextDistance;
+					myBuckets[nextDistance % bucketCount].push_back(next);
+					++queuedCount;
+				}
+			}
+		}
+
+		queuedCount -= bucket.size();
+		bucket.clear();
+	}
+}
+
+void FlowField::BuildDirections()
+{
+	myDirections.resize(static_cast<size_t>(myWidth) * myHeight);
+	myRowBest.resize(myWidth);
+	myRowDirections.resize(myWidth);
+
+	// Straight directions come first so they win ties
+	constexpr int order[8] = { 0, 2, 4, 6, 1, 3, 5, 7 };
+
+	constexpr int straightCost = DiagonalCostPolicy::ourStraightCost;
+	constexpr int diagonalCost = DiagonalCostPolicy::ourDiagonalCost;
+
+	// Kept in a local since the stores below could otherwise change the member and the loops would not vectorize
+	const int width = myWidth;
+
+	for (int y = 0; y < myHeight; ++y)
+	{
+		const int* distances = myDistances.data() + GetIndex(0, y);
+		const int* walls = myWalls.data() + GetIndex(0, y);
+		const int* costs = myCosts.data() + GetIndex(0, y);
+		int* best = myRowBest.data();
+		int* directions = myRowDirections.data();
+
+		// Cells that can not reach the goal keep -1 since no neighbor is below ourUnreachable, walls start below every distance
+		for (int x = 0; x < width; ++x)
+		{
+			best[x] = walls[x] == 0 ? ourUnreachable : -1;
+			directions[x] = -1;
+		}
+
+		for (const int direction : order)
+		{
+			const int offset = ourDirectionY[direction] * myStride + ourDirectionX[direction];
+			const int* next = distances + offset;
+			const int* nextCosts = costs + offset;
+
+			// A diagonal step is only allowed when both cells beside it are open
+			const int* wallX = walls + ourDirectionX[direction];
+			const int* wallY = walls + ourDirectionY[direction] * myStride;
+			const bool diagonal = direction % 2 == 1;
+			const int stepCost = diagonal ? diagonalCost : straightCost;
+
+			// Walls cost nothing and are ourUnreachable away, which stays unreachable with any step cost added
+			for (int x = 0; x < width; ++x)
+			{
+				const int distance = (diagonal ? std::max(next[x], std::max(wallX[x], wallY[x])) : next[x]) + stepCost * nextCosts[x];
+				const bool closer = distance < best[x];
+
+				best[x] = closer ? distance : best[x];
+				directions[x] = closer ? direction : directions[x];
+			}
+		}
+
+		// Packed afterwards, stores through an int8_t pointer could alias the other rows and keep the loops above scalar
+		std::copy(directions, directions + width, myDirections.begin() + static_cast<size_t>(y) * width);
+	}
+
+	// The goal is the only cell with no neighbor closer than itself
+	if (myDistances[GetIndex(myGoalLocation.x, myGoalLocation.y)] == 0)
+	{
+		myDirections[static_cast<size_t>(myGoalLocation.y) * width + myGoalLocation.x] = -1;
+	}
+}
+
+std::shared_ptr<const FlowField> FlowFieldCache::Get(Grid& aSearchGrid, const GridLocation& aGoalLocation)
+{
+	++myUseCounter;
+
+	auto found = myFields.find(aGoalLocation);
+	if (found != myFields.end())
+	{
+		found->second.lastUse = myUseCounter;
+		return found->second.field;
+	}
+
+	if (myFields.size() >= myCapacity && !myFields.empty())
+	{
+		auto oldest = std::min_element(myFields.begin(), myFields.end(), [](const auto& aFirst, const auto& aSecond)
+		{
+			return aFirst.second.lastUse < aSecond.second.lastUse;
+		});
+
+		myFields.erase(oldest);
+	}
+
+	auto field = std::make_shared<FlowField>();
+	field->Build(aSearchGrid, aGoalLocation);
+
+	myFields[aGoalLocation] = { field, myUseCounter };
+	return field;
+}
+
+void FlowFieldCache::Clear()
+{
+	myFields.clear();
+}
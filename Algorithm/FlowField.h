@@ -0,0 +1,107 @@
+#pragma once
+
+#include "AStar.h"
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+class Grid;
+
+
+/*
+	Distance to one goal for every cell of the grid and the step to take from each cell, so any number of agents
+	heading for the same goal can look up their next step in constant time.
+	The distances are an eight way Dijkstra search from the goal with the step costs of TerrainCostPolicy, so they are the
+	costs AStar finds with that policy, or with DiagonalCostPolicy when every cell costs one. Its queue is a ring of buckets,
+	one per distance up to the most expensive step, so a cell is queued and taken out in constant time.
+	The steps are then picked a row at a time without branches, each to the neighbor whose step cost plus distance is the lowest.
+	Both arrays have a border of one wall cell around the grid so neighbors never need a bounds check.
+*/
+class FlowField
+{
+
+	public:
+		void Build(Grid& aSearchGrid, const GridLocation& aGoalLocation);
+
+		// Offset of the next cell towards the goal, zero at the goal and on cells that can not reach it
+		GridLocation GetStep(const GridLocation& aLocation) const;
+
+		// Cost of the shortest path to the goal, which is what following GetStep costs, -1 when the goal can not be reached
+		int GetDistance(const GridLocation& aLocation) const;
+
+		inline const GridLocation& GetGoal() const { return myGoalLocation; }
+		inline int GetWidth() const { return myWidth; }
+		inline int GetHeight() const { return myHeight; }
+
+	private:
+		// Larger than any distance and still safe to add a step cost to
+		static constexpr int ourUnreachable = INT_MAX / 2;
+
+		// Eight directions clockwise from north, diagonals have odd indices
+		static constexpr int ourDirectionX[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+		static constexpr int ourDirectionY[8] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+
+		void BuildDistances();
+		void BuildDirections();
+
+		inline int GetIndex(const int aX, const int aY) const { return (aY + 1) * myStride + aX + 1; }
+
+	private:
+		std::vector<int> myDistances;
+
+		// Zero on walkable cells and ourUnreachable on walls, so a max makes a diagonal past a wall unreachable
+		std::vector<int> myWalls;
+
+		// Cost of stepping onto a cell, zero on walls
+		std::vector<int> myCosts;
+
+		// Index into the direction tables, -1 when there is no step, without the border
+		std::vector<int8_t> myDirections;
+
+		// Cells by distance modulo the bucket count
+		std::vector<std::vector<int>> myBuckets;
+		std::vector<int> myRowBest;
+		std::vector<int> myRowDirections;
+
+		GridLocation myGoalLocation;
+
+		int myWidth = 0;
+		int myHeight = 0;
+		int myStride = 0;
+		int myMaxCost = 1;
+
+};
+
+
+/*
+	Keeps the flow fields of the most recently used goals. Fields are shared so an agent can keep using its field
+	after it has been evicted. Call Clear when the walkability of the grid changes.
+*/
+class FlowFieldCache
+{
+
+	public:
+		std::shared_ptr<const FlowField> Get(Grid& aSearchGrid, const GridLocation& aGoalLocation);
+
+		void Clear();
+
+		inline void SetCapacity(const size_t aCapacity) { myCapacity = aCapacity; }
+		inline size_t GetCapacity() const { return myCapacity; }
+		inline size_t Size() const { return myFields.size(); }
+
+	private:
+		struct Entry
+		{
+			std::shared_ptr<FlowField> field;
+			uint64_t lastUse;
+		};
+
+	private:
+		std::unordered_map<GridLocation, Entry, GridLocation::HashFunction> myFields;
+
+		size_t myCapacity = 16;
+		uint64_t myUseCounter = 0;
+
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <climits>
+
+struct GridLocation
+{
+	GridLocation() : x(), y() {}
+	GridLocation(int aX, int aY) : x(aX), y(aY) {}
+
+	bool operator==(const GridLocation& aOtherGridLocation) const
+	{
+		return x == aOtherGridLocation.x && y == aOtherGridLocation.y;
+	}
+
+	int x;
+	int y;
+
+	struct HashFunction
+	{
+		size_t operator()(const GridLocation& aGridLocation) const noexcept
+		{
+			return static_cast<size_t>(aGridLocation.x) + static_cast<size_t>(INT_MAX) * static_cast<size_t>(aGridLocation.y);
+		}
+	};
+};
+
+struct CellCost
+{
+	int gCost;
+	int hCost;
+
+	GridLocation location;
+
+	int Cost() const
+	{
+		return gCost + hCost;
+	}
+
+	bool operator<(const CellCost& other) const
+	{
+		// For priority queue (min-heap), on equal cost the entry closer to the goal comes first
+		return Cost() > other.Cost() || (Cost() == other.Cost() && hCost > other.hCost);
+	}
+};
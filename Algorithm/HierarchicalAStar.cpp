@@ -0,0 +1,468 @@
+#include "HierarchicalAStar.h"
+
+#include <cstdlib>
+#include <climits>
+#include <algorithm>
+
+void HierarchicalAStar::Build(Grid& aSearchGrid, const int aClusterSize)
+{
+	myWidth = aSearchGrid.GetWidth();
+	myHeight = aSearchGrid.GetHeight();
+	myClusterSize = aClusterSize;
+	myClusterColumns = (myWidth + aClusterSize - 1) / aClusterSize;
+	myClusterRows = (myHeight + aClusterSize - 1) / aClusterSize;
+
+	myClusters.clear();
+	myNodes.clear();
+	myFreeNodes.clear();
+	myDirtyBorders.clear();
+	myDirtyClusters.clear();
+
+	// Clusters on the right and bottom edge are cut to the grid
+	for (int row = 0; row < myClusterRows; ++row)
+	{
+		for (int column = 0; column < myClusterColumns; ++column)
+		{
+			HPACluster cluster;
+			cluster.x = column * aClusterSize;
+			cluster.y = row * aClusterSize;
+			cluster.width = std::min(aClusterSize, myWidth - cluster.x);
+			cluster.height = std::min(aClusterSize, myHeight - cluster.y);
+
+			myClusters.push_back(cluster);
+		}
+	}
+
+	myBorderDirty.assign(myClusters.size() * 2, false);
+
+	for (int cluster = 0; cluster < GetClusterCount(); ++cluster)
+	{
+		MarkClusterDirty(cluster);
+
+		if (cluster % myClusterColumns + 1 < myClusterColumns)
+		{
+			MarkBorderDirty(cluster * 2);
+		}
+
+		if (cluster / myClusterColumns + 1 < myClusterRows)
+		{
+			MarkBorderDirty(cluster * 2 + 1);
+		}
+	}
+
+	UpdateDirtyClusters(aSearchGrid);
+}
+
+void HierarchicalAStar::MarkCellChanged(const GridLocation& aLocation)
+{
+	if (myClusters.empty())
+	{
+		return;
+	}
+
+	const int cluster = GetClusterIndex(aLocation);
+	const int column = cluster % myClusterColumns;
+	const int row = cluster / myClusterColumns;
+	const HPACluster& bounds = myClusters[cluster];
+
+	MarkClusterDirty(cluster);
+
+	// Entrances only depend on the cells on both sides of a border
+	if (aLocation.x == bounds.x && column > 0)
+	{
+		MarkBorderDirty((cluster - 1) * 2);
+	}
+
+	if (aLocation.x == bounds.x + bounds.width - 1 && column + 1 < myClusterColumns)
+	{
+		MarkBorderDirty(cluster * 2);
+	}
+
+	if (aLocation.y == bounds.y && row > 0)
+	{
+		MarkBorderDirty((cluster - myClusterColumns) * 2 + 1);
+	}
+
+	if (aLocation.y == bounds.y + bounds.height - 1 && row + 1 < myClusterRows)
+	{
+		MarkBorderDirty(cluster * 2 + 1);
+	}
+}
+
+void HierarchicalAStar::UpdateDirtyClusters(Grid& aSearchGrid)
+{
+	for (const int border : myDirtyBorders)
+	{
+		RebuildBorder(aSearchGrid, border);
+		myBorderDirty[border] = false;
+	}
+
+	for (const int cluster : myDirtyClusters)
+	{
+		ComputeClusterEdges(aSearchGrid, cluster);
+		myClusters[cluster].dirty = false;
+	}
+
+	myDirtyBorders.clear();
+	myDirtyClusters.clear();
+}
+
+std::vector<GridLocation> HierarchicalAStar::FindPath(Grid& aSearchGrid, GridLocation aStartLocation, GridLocation aGoalLocation)
+{
+	const std::vector<GridLocation> waypoints = FindAbstractPath(aSearchGrid, aStartLocation, aGoalLocation);
+
+	std::vector<GridLocation> path;
+
+	// Segments are refined from the goal end so they can be appended in the order of the path
+	for (size_t i = 0; i < waypoints.size(); ++i)
+	{
+		const GridLocation from = i + 1 < waypoints.size() ? waypoints[i + 1] : aStartLocation;
+
+		const std::vector<GridLocation> segment = myAStar.FindPath(aSearchGrid, from, waypoints[i]);
+		if (segment.empty())
+		{
+			return {};
+		}
+
+		path.insert(path.end(), segment.begin(), segment.end());
+	}
+
+	return path;
+}
+
+std::vector<GridLocation> HierarchicalAStar::FindAbstractPath(Grid& aSearchGrid, GridLocation aStartLocation, GridLocation aGoalLocation)
+{
+	if (!myDirtyClusters.empty())
+	{
+		UpdateDirtyClusters(aSearchGrid);
+	}
+
+	if (aStartLocation == aGoalLocation)
+	{
+		return {};
+	}
+
+	const int goalCluster = GetClusterIndex(aGoalLocation);
+	if (GetClusterIndex(aStartLocation) == goalCluster)
+	{
+		return { aGoalLocation };
+	}
+
+	// The start and the goal are added to the graph for this search only, after the entrances
+	const int startNode = static_cast<int>(myNodes.size());
+	const int goalNode = startNode + 1;
+
+	std::vector<HPAEdge> startEdges;
+	std::vector<HPAEdge> goalEdges;
+	ConnectToCluster(aSearchGrid, aStartLocation, startEdges);
+	ConnectToCluster(aSearchGrid, aGoalLocation, goalEdges);
+
+	auto getLocation = [&](const int aNode)
+	{
+		return aNode == startNode ? aStartLocation : aNode == goalNode ? aGoalLocation : myNodes[aNode].location;
+	};
+
+	auto relax = [&](const int aFrom, const int aTo, const int aCost)
+	{
+		SearchNode& node = mySearchNodes[aTo];
+		const int gCost = mySearchNodes[aFrom].gCost + aCost;
+		if (node.closed || gCost >= node.gCost)
+		{
+			return;
+		}
+
+		node.gCost = gCost;
+		node.parent = aFrom;
+
+		const GridLocation location = getLocation(aTo);
+		const int hCost = std::abs(location.x - aGoalLocation.x) + std::abs(location.y - aGoalLocation.y);
+
+		myFrontier.push_back({ gCost + hCost, aTo });
+		std::push_heap(myFrontier.begin(), myFrontier.end());
+	};
+
+	mySearchNodes.assign(myNodes.size() + 2, { INT_MAX, -1, false });
+	mySearchNodes[startNode].gCost = 0;
+
+	myFrontier.clear();
+	myFrontier.push_back({ 0, startNode });
+
+	while (!myFrontier.empty())
+	{
+		std::pop_heap(myFrontier.begin(), myFrontier.end());
+		const int current = myFrontier.back().node;
+		myFrontier.pop_back();
+
+		if (mySearchNodes[current].closed)
+		{
+			continue;
+		}
+
+		mySearchNodes[current].closed = true;
+
+		if (current == goalNode)
+		{
+			break;
+		}
+
+		if (current == startNode)
+		{
+			for (const HPAEdge& edge : startEdges)
+			{
+				relax(current, edge.node, edge.cost);
+			}
+
+			continue;
+		}
+
+		const HPANode& node = myNodes[current];
+		for (const HPAEdge& edge : node.edges)
+		{
+			relax(current, edge.node, edge.cost);
+		}
+
+		relax(current, node.partner, 1);
+
+		if (node.cluster == goalCluster)
+		{
+			for (const HPAEdge& edge : goalEdges)
+			{
+				if (edge.node == current)
+				{
+					relax(current, goalNode, edge.cost);
+				}
+			}
+		}
+	}
+
+	if (!mySearchNodes[goalNode].closed)
+	{
+		// No Path
+		return {};
+	}
+
+	std::vector<GridLocation> waypoints;
+	for (int node = goalNode; node != startNode; node = mySearchNodes[node].parent)
+	{
+		// An entrance on the start or goal cell gives the same location twice
+		const GridLocation location = getLocation(node);
+		if ((waypoints.empty() || !(waypoints.back() == location)) && !(location == aStartLocation))
+		{
+			waypoints.push_back(location);
+		}
+	}
+
+	return waypoints;
+}
+
+int HierarchicalAStar::GetClusterIndex(const GridLocation& aLocation) const
+{
+	return (aLocation.y / myClusterSize) * myClusterColumns + aLocation.x / myClusterSize;
+}
+
+void HierarchicalAStar::MarkClusterDirty(const int aCluster)
+{
+	if (!myClusters[aCluster].dirty)
+	{
+		myClusters[aCluster].dirty = true;
+		myDirtyClusters.push_back(aCluster);
+	}
+}
+
+void HierarchicalAStar::MarkBorderDirty(const int aBorder)
+{
+	const int cluster = aBorder / 2;
+	const int otherCluster = aBorder % 2 == 0 ? cluster + 1 : cluster + myClusterColumns;
+
+	// The entrances of both clusters change, so both need new distances
+	MarkClusterDirty(cluster);
+	MarkClusterDirty(otherCluster);
+
+	if (!myBorderDirty[aBorder])
+	{
+		myBorderDirty[aBorder] = true;
+		myDirtyBorders.push_back(aBorder);
+	}
+}
+
+void HierarchicalAStar::RebuildBorder(Grid& aSearchGrid, const int aBorder)
+{
+	const int cluster = aBorder / 2;
+	const bool south = aBorder % 2 == 1;
+	const int otherCluster = south ? cluster + myClusterColumns : cluster + 1;
+
+	RemoveBorderNodes(myClusters[cluster], aBorder);
+	RemoveBorderNodes(myClusters[otherCluster], aBorder);
+
+	// Walks the last row or column of the cluster, the other side is one step south or east
+	const HPACluster& bounds = myClusters[cluster];
+	const GridLocation first = south ? GridLocation(bounds.x, bounds.y + bounds.height - 1) : GridLocation(bounds.x + bounds.width - 1, bounds.y);
+	const GridLocation along = south ? GridLocation(1, 0) : GridLocation(0, 1);
+	const GridLocation across = south ? GridLocation(0, 1) : GridLocation(1, 0);
+	const int length = south ? bounds.width : bounds.height;
+
+	auto addEntrance = [&](const int aOffset)
+	{
+		const GridLocation location(first.x + along.x * aOffset, first.y + along.y * aOffset);
+		AddEntrance(location, GridLocation(location.x + across.x, location.y + across.y), cluster, otherCluster, aBorder);
+	};
+
+	int openingStart = -1;
+	for (int i = 0; i <= length; ++i)
+	{
+		bool open = false;
+		if (i < length)
+		{
+			const GridLocation location(first.x + along.x * i, first.y + along.y * i);
+			open = aSearchGrid.GetCell(location).walkable && aSearchGrid.GetCell(GridLocation(location.x + across.x, location.y + across.y)).walkable;
+		}
+
+		if (open && openingStart == -1)
+		{
+			openingStart = i;
+		}
+		else if (!open && openingStart != -1)
+		{
+			const int openingLength = i - openingStart;
+			if (openingLength >= ourLongEntranceLength)
+			{
+				addEntrance(openingStart);
+				addEntrance(i - 1);
+			}
+			else
+			{
+				addEntrance(openingStart + openingLength / 2);
+			}
+
+			openingStart = -1;
+		}
+	}
+}
+
+void HierarchicalAStar::RemoveBorderNodes(HPACluster& aCluster, const int aBorder)
+{
+	auto removed = std::remove_if(aCluster.nodes.begin(), aCluster.nodes.end(), [&](const int aNode)
+	{
+		if (myNodes[aNode].border != aBorder)
+		{
+			return false;
+		}
+
+		myNodes[aNode] = HPANode();
+		myFreeNodes.push_back(aNode);
+		return true;
+	});
+
+	aCluster.nodes.erase(removed, aCluster.nodes.end());
+}
+
+void HierarchicalAStar::AddEntrance(const GridLocation& aLocation, const GridLocation& aOtherLocation, const int aCluster, const int aOtherCluster, const int aBorder)
+{
+	const int node = AllocateNode();
+	const int otherNode = AllocateNode();
+
+	myNodes[node].location = aLocation;
+	myNodes[node].cluster = aCluster;
+	myNodes[node].border = aBorder;
+	myNodes[node].partner = otherNode;
+
+	myNodes[otherNode].location = aOtherLocation;
+	myNodes[otherNode].cluster = aOtherCluster;
+	myNodes[otherNode].border = aBorder;
+	myNodes[otherNode].partner = node;
+
+	myClusters[aCluster].nodes.push_back(node);
+	myClusters[aOtherCluster].nodes.push_back(otherNode);
+}
+
+int HierarchicalAStar::AllocateNode()
+{
+	if (!myFreeNodes.empty())
+	{
+		const int node = myFreeNodes.back();
+		myFreeNodes.pop_back();
+		return node;
+	}
+
+	myNodes.emplace_back();
+	return static_cast<int>(myNodes.size()) - 1;
+}
+
+void HierarchicalAStar::ComputeClusterEdges(Grid& aSearchGrid, const int aCluster)
+{
+	const HPACluster& cluster = myClusters[aCluster];
+
+	for (const int node : cluster.nodes)
+	{
+		std::vector<HPAEdge>& edges = myNodes[node].edges;
+		edges.clear();
+
+		SearchCluster(aSearchGrid, cluster, myNodes[node].location);
+
+		for (const int otherNode : cluster.nodes)
+		{
+			const int distance = GetClusterDistance(cluster, myNodes[otherNode].location);
+			if (otherNode != node && distance >= 0)
+			{
+				edges.push_back({ otherNode, distance });
+			}
+		}
+	}
+}
+
+void HierarchicalAStar::SearchCluster(Grid& aSearchGrid, const HPACluster& aCluster, const GridLocation& aLocation)
+{
+	static constexpr int directionX[4] = { 1, -1, 0, 0 };
+	static constexpr int directionY[4] = { 0, 0, 1, -1 };
+
+	myClusterDistances.assign(static_cast<size_t>(aCluster.width) * aCluster.height, -1);
+	myClusterQueue.clear();
+
+	myClusterDistances[(aLocation.y - aCluster.y) * aCluster.width + aLocation.x - aCluster.x] = 0;
+	myClusterQueue.push_back(aLocation);
+
+	for (size_t i = 0; i < myClusterQueue.size(); ++i)
+	{
+		const GridLocation current = myClusterQueue[i];
+		const int distance = GetClusterDistance(aCluster, current);
+
+		for (int direction = 0; direction < 4; ++direction)
+		{
+			const GridLocation next(current.x + directionX[direction], current.y + directionY[direction]);
+			if (next.x < aCluster.x || next.y < aCluster.y || next.x >= aCluster.x + aCluster.width || next.y >= aCluster.y + aCluster.height)
+			{
+				continue;
+			}
+
+			int& nextDistance = myClusterDistances[(next.y - aCluster.y) * aCluster.width + next.x - aCluster.x];
+			if (nextDistance != -1 || !aSearchGrid.GetCell(next).walkable)
+			{
+				continue;
+			}
+
+			nextDistance = distance + 1;
+			myClusterQueue.push_back(next);
+		}
+	}
+}
+
+int HierarchicalAStar::GetClusterDistance(const HPACluster& aCluster, const GridLocation& aLocation) const
+{
+	return myClusterDistances[(aLocation.y - aCluster.y) * aCluster.width + aLocation.x - aCluster.x];
+}
+
+void HierarchicalAStar::ConnectToCluster(Grid& aSearchGrid, const GridLocation& aLocation, std::vector<HPAEdge>& outEdges)
+{
+	const HPACluster& cluster = myClusters[GetClusterIndex(aLocation)];
+
+	SearchCluster(aSearchGrid, cluster, aLocation);
+
+	for (const int node : cluster.nodes)
+	{
+		const int distance = GetClusterDistance(cluster, myNodes[node].location);
+		if (distance >= 0)
+		{
+			outEdges.push_back({ node, distance });
+		}
+	}
+}
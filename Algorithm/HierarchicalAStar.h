@@ -0,0 +1,134 @@
+#pragma once
+
+#include "AStar.h"
+
+#include <vector>
+
+class Grid;
+
+struct HPAEdge
+{
+	int node;
+	int cost;
+};
+
+// An entrance cell on the border of a cluster, its partner is the cell on the other side
+struct HPANode
+{
+	GridLocation location;
+
+	int cluster = -1;
+	int border = -1;
+	int partner = -1;
+
+	// Distances to the other nodes of the cluster that can be reached without leaving it
+	std::vector<HPAEdge> edges;
+};
+
+struct HPACluster
+{
+	int x = 0;
+	int y = 0;
+	int width = 0;
+	int height = 0;
+
+	std::vector<int> nodes;
+
+	bool dirty = false;
+};
+
+
+/*
+	HPA*: the grid is split into square clusters and every walkable opening between two clusters gets a pair of entrance nodes.
+	Distances between the entrances of a cluster are precomputed, so a long search only runs over the entrances and
+	AStar is only used on the short segments between them.
+	Each border between two clusters has an index, cluster * 2 for the east border and cluster * 2 + 1 for the south border.
+	Changing a cell only rebuilds the borders it is on and the clusters next to them.
+*/
+class HierarchicalAStar
+{
+
+	public:
+		void Build(Grid& aSearchGrid, const int aClusterSize = 16);
+
+		// Call after the walkability of a cell has changed, the affected clusters are rebuilt before the next search
+		void MarkCellChanged(const GridLocation& aLocation);
+
+		// Rebuilds the entrances and distances of the clusters marked since the last update
+		void UpdateDirtyClusters(Grid& aSearchGrid);
+
+		// Same path shape as AStar, from the goal back to the first step after the start
+		std::vector<GridLocation> FindPath(Grid& aSearchGrid, GridLocation aStartLocation, GridLocation aGoalLocation);
+
+		// Entrances the path passes through ending with the goal, in the same order as FindPath.
+		// Each segment can be refined with AStar when the agent gets to it.
+		std::vector<GridLocation> FindAbstractPath(Grid& aSearchGrid, GridLocation aStartLocation, GridLocation aGoalLocation);
+
+		inline int GetClusterCount() const { return static_cast<int>(myClusters.size()); }
+		inline const HPACluster& GetCluster(const int aIndex) const { return myClusters[aIndex]; }
+		inline const std::vector<HPANode>& GetNodes() const { return myNodes; }
+
+	private:
+		// Openings at least this long get an entrance at both ends instead of one in the middle
+		static constexpr int ourLongEntranceLength = 6;
+
+		struct SearchNode
+		{
+			int gCost;
+			int parent;
+			bool closed;
+		};
+
+		struct FrontierEntry
+		{
+			int fCost;
+			int node;
+
+			bool operator<(const FrontierEntry& other) const
+			{
+				return fCost > other.fCost; // For the heap (min-heap)
+			}
+		};
+
+		int GetClusterIndex(const GridLocation& aLocation) const;
+
+		void MarkClusterDirty(const int aCluster);
+		void MarkBorderDirty(const int aBorder);
+		void RebuildBorder(Grid& aSearchGrid, const int aBorder);
+		void RemoveBorderNodes(HPACluster& aCluster, const int aBorder);
+		void AddEntrance(const GridLocation& aLocation, const GridLocation& aOtherLocation, const int aCluster, const int aOtherCluster, const int aBorder);
+		int AllocateNode();
+
+		void ComputeClusterEdges(Grid& aSearchGrid, const int aCluster);
+
+		// Breadth first search limited to the cluster, fills myClusterDistances with the distance to every cell of it, -1 when unreachable
+		void SearchCluster(Grid& aSearchGrid, const HPACluster& aCluster, const GridLocation& aLocation);
+		int GetClusterDistance(const HPACluster& aCluster, const GridLocation& aLocation) const;
+
+		// Edges from a cell that is not an entrance to the entrances of its cluster
+		void ConnectToCluster(Grid& aSearchGrid, const GridLocation& aLocation, std::vector<HPAEdge>& outEdges);
+
+	private:
+		std::vector<HPACluster> myClusters;
+		std::vector<HPANode> myNodes;
+		std::vector<int> myFreeNodes;
+
+		std::vector<int> myDirtyBorders;
+		std::vector<bool> myBorderDirty;
+		std::vector<int> myDirtyClusters;
+
+		std::vector<int> myClusterDistances;
+		std::vector<GridLocation> myClusterQueue;
+
+		std::vector<SearchNode> mySearchNodes;
+		std::vector<FrontierEntry> myFrontier;
+
+		AStar<> myAStar;
+
+		int myClusterSize = 16;
+		int myClusterColumns = 0;
+		int myClusterRows = 0;
+		int myWidth = 0;
+		int myHeight = 0;
+
+};
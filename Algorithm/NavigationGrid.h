@@ -0,0 +1,200 @@
+#pragma once
+
+#include "GridLocation.h"
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+#include <algorithm>
+
+enum class eNavigationLayout
+{
+	// One bit per cell, a row after row
+	Rows,
+
+	// 8x8 cells per 64 bit word, so the cells around one are in one or two words instead of three rows
+	Tiles,
+};
+
+// What AStar reads from a cell, a navigation grid only knows walkability so every cell costs one
+struct NavigationCell
+{
+	bool walkable;
+	int cost;
+};
+
+
+/*
+	Walkability of a Grid packed into bits for the searches. It has a border of one blocked cell around it,
+	so GetNeighborMask and IsWalkable never check bounds and can be given cells just outside the grid.
+	AStar expands a cell with one GetNeighborMask call instead of a GetNeighbors container and a GetCell per neighbor.
+	Costs are not kept, use Grid with TerrainCostPolicy.
+*/
+template<eNavigationLayout Layout = eNavigationLayout::Tiles>
+class NavigationGrid
+{
+
+	public:
+		// Eight directions clockwise from north, bit i of a neighbor mask is direction i, diagonals have odd indices
+		static constexpr int ourDirectionX[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+		static constexpr int ourDirectionY[8] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+
+		// Copies the walkability of any grid with GetWidth, GetHeight and GetCell
+		template<class SourceGrid>
+		void Build(SourceGrid& aSourceGrid);
+
+		// Every cell starts blocked
+		void Resize(const int aWidth, const int aHeight);
+
+		void SetWalkable(const GridLocation& aLocation, const bool aWalkable);
+
+		// Cells from -1 to the width and height can be asked for, the border is blocked
+		inline bool IsWalkable(const int aX, const int aY) const
+		{
+			int bit;
+			const size_t word = GetWord(aX + 1, aY + 1, bit);
+
+			return (myBits[word] >> bit) & 1;
+		}
+
+		inline NavigationCell GetCell(const GridLocation& aLocation) const { return { IsWalkable(aLocation.x, aLocation.y), 1 }; }
+
+		// Bit per direction for the neighbors that can be stepped to, diagonals only when both cells beside them are walkable
+		uint8_t GetNeighborMask(const GridLocation& aLocation) const;
+
+		inline int GetWidth() const { return myWidth; }
+		inline int GetHeight() const { return myHeight; }
+
+	private:
+		// Word and bit of a cell in padded coordinates
+		inline size_t GetWord(const int aPaddedX, const int aPaddedY, int& outBit) const
+		{
+			if constexpr (Layout == eNavigationLayout::Tiles)
+			{
+				outBit = (aPaddedY & 7) * 8 + (aPaddedX & 7);
+				return static_cast<size_t>(aPaddedY >> 3) * myWordsPerRow + (aPaddedX >> 3);
+			}
+			else
+			{
+				outBit = aPaddedX & 63;
+				return static_cast<size_t>(aPaddedY) * myWordsPerRow + (aPaddedX >> 6);
+			}
+		}
+
+		// Three cells of a row in padded coordinates starting at aPaddedX, in the lowest bits
+		uint32_t GetRowBits(const int aPaddedX, const int aPaddedY) const;
+
+	private:
+		std::vector<uint64_t> myBits;
+
+		// Words per row of cells, or per row of tiles
+		int myWordsPerRow = 0;
+
+		int myWidth = 0;
+		int myHeight = 0;
+
+};
+
+template<eNavigationLayout Layout>
+template<class SourceGrid>
+inline void NavigationGrid<Layout>::Build(SourceGrid& aSourceGrid)
+{
+	Resize(aSourceGrid.GetWidth(), aSourceGrid.GetHeight());
+
+	for (int y = 0; y < myHeight; ++y)
+	{
+		for (int x = 0; x < myWidth; ++x)
+		{
+			const GridLocation location(x, y);
+			SetWalkable(location, aSourceGrid.GetCell(location).walkable);
+		}
+	}
+}
+
+template<eNavigationLayout Layout>
+inline void NavigationGrid<Layout>::Resize(const int aWidth, const int aHeight)
+{
+	myWidth = aWidth;
+	myHeight = aHeight;
+
+	const int paddedWidth = aWidth + 2;
+	const int paddedHeight = aHeight + 2;
+
+	size_t wordCount;
+	if constexpr (Layout == eNavigationLayout::Tiles)
+	{
+		myWordsPerRow = (paddedWidth + 7) / 8;
+		wordCount = static_cast<size_t>(myWordsPerRow) * ((paddedHeight + 7) / 8);
+	}
+	else
+	{
+		myWordsPerRow = (paddedWidth + 63) / 64;
+		wordCount = static_cast<size_t>(myWordsPerRow) * paddedHeight;
+	}
+
+	myBits.assign(wordCount, 0);
+}
+
+template<eNavigationLayout Layout>
+inline void NavigationGrid<Layout>::SetWalkable(const GridLocation& aLocation, const bool aWalkable)
+{
+	assert(aLocation.x >= 0 && aLocation.y >= 0 && aLocation.x < myWidth && aLocation.y < myHeight && "Cell is outside the grid");
+
+	int bit;
+	const size_t word = GetWord(aLocation.x + 1, aLocation.y + 1, bit);
+
+	myBits[word] = (myBits[word] & ~(uint64_t(1) << bit)) | (uint64_t(aWalkable) << bit);
+}
+
+template<eNavigationLayout Layout>
+inline uint8_t NavigationGrid<Layout>::GetNeighborMask(const GridLocation& aLocation) const
+{
+	// The padded column of the cell to the west
+	const int x = aLocation.x;
+	const int y = aLocation.y + 1;
+
+	const uint32_t above = GetRowBits(x, y - 1);
+	const uint32_t row = GetRowBits(x, y);
+	const uint32_t below = GetRowBits(x, y + 1);
+
+	// Bit 0 of each row is the west cell, bit 1 the cell itself and bit 2 the east cell
+	const uint32_t cells =
+		((above >> 1) & 1) | ((above >> 2) & 1) << 1 | ((row >> 2) & 1) << 2 | ((below >> 2) & 1) << 3 |
+		((below >> 1) & 1) << 4 | (below & 1) << 5 | (row & 1) << 6 | (above & 1) << 7;
+
+	// A diagonal needs the straight directions on both sides of it, the one after north west is north
+	const uint32_t straight = cells & 0x55;
+	const uint32_t corners = (straight << 1) & ((straight >> 1) | (straight << 7)) & 0xAA;
+
+	return static_cast<uint8_t>(straight | (cells & corners));
+}
+
+template<eNavigationLayout Layout>
+inline uint32_t NavigationGrid<Layout>::GetRowBits(const int aPaddedX, const int aPaddedY) const
+{
+	int bit;
+	const size_t word = GetWord(aPaddedX, aPaddedY, bit);
+
+	if constexpr (Layout == eNavigationLayout::Tiles)
+	{
+		// The eight cells of the row in this tile, followed by the ones in the next tile when the three cross into it
+		uint32_t bits = static_cast<uint32_t>(myBits[word] >> (bit & ~7)) & 0xFF;
+		if ((bit & 7) > 5)
+		{
+			bits |= (static_cast<uint32_t>(myBits[word + 1] >> (bit & ~7)) & 0xFF) << 8;
+		}
+
+		return (bits >> (bit & 7)) & 7;
+	}
+	else
+	{
+		uint64_t bits = myBits[word] >> bit;
+		if (bit > 61)
+		{
+			bits |= myBits[word + 1] << (64 - bit);
+		}
+
+		return static_cast<uint32_t>(bits) & 7;
+	}
+}
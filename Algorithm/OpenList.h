@@ -0,0 +1,313 @@
+#pragma once
+
+#include "GridLocation.h"
+
+#include <vector>
+#include <climits>
+#include <algorithm>
+
+/*
+	Open lists for AStar. Push adds a cell or lowers its cost when it is already in the list, aIndex is the index
+	of the cell in the grid. Clear empties the list and makes room for aCellCount cells, memory is kept between searches.
+*/
+
+// Binary heap that gets a new entry every time a cell gets cheaper, the search skips the stale ones when they are popped
+class BinaryHeapOpenList
+{
+
+	public:
+		inline void Clear(const size_t /*aCellCount*/) { myHeap.clear(); }
+
+		inline void Push(const CellCost& aCell, const int /*aIndex*/)
+		{
+			myHeap.push_back(aCell);
+			std::push_heap(myHeap.begin(), myHeap.end());
+		}
+
+		inline bool Pop(CellCost& outCell)
+		{
+			if (myHeap.empty())
+			{
+				return false;
+			}
+
+			std::pop_heap(myHeap.begin(), myHeap.end());
+			outCell = myHeap.back();
+			myHeap.pop_back();
+
+			return true;
+		}
+
+		inline size_t Size() const { return myHeap.size(); }
+
+	private:
+		std::vector<CellCost> myHeap;
+
+};
+
+
+/*
+	Heap with Arity children per node that knows the position of every cell in it, so a cell that gets cheaper is moved up
+	in place instead of being added again. Four children make the heap half as deep as a binary one and the children
+	of a node share a cache line.
+*/
+template<int Arity = 4>
+class IndexedHeapOpenList
+{
+
+	public:
+		void Clear(const size_t aCellCount);
+		void Push(const CellCost& aCell, const int aIndex);
+		bool Pop(CellCost& outCell);
+
+		inline size_t Size() const { return myHeap.size(); }
+
+	private:
+		struct Entry
+		{
+			CellCost cell;
+			int index;
+		};
+
+		void SiftUp(int aPosition);
+		void SiftDown(int aPosition);
+
+		inline void Place(const Entry& aEntry, const int aPosition)
+		{
+			myHeap[aPosition] = aEntry;
+			myPositions[aEntry.index] = aPosition;
+		}
+
+	private:
+		std::vector<Entry> myHeap;
+
+		// Position of each cell in the heap, -1 when it is not in it
+		std::vector<int> myPositions;
+
+};
+
+template<int Arity>
+inline void IndexedHeapOpenList<Arity>::Clear(const size_t aCellCount)
+{
+	// Only cells still in the heap have a position set
+	for (const Entry& entry : myHeap)
+	{
+		myPositions[entry.index] = -1;
+	}
+
+	myHeap.clear();
+
+	if (myPositions.size() < aCellCount)
+	{
+		myPositions.resize(aCellCount, -1);
+	}
+}
+
+template<int Arity>
+inline void IndexedHeapOpenList<Arity>::Push(const CellCost& aCell, const int aIndex)
+{
+	const int position = myPositions[aIndex];
+	if (position != -1)
+	{
+		// AStar only pushes a cell again when it got cheaper, so it can only move up
+		myHeap[position].cell = aCell;
+		SiftUp(position);
+		return;
+	}
+
+	myHeap.push_back({ aCell, aIndex });
+	myPositions[aIndex] = static_cast<int>(myHeap.size()) - 1;
+	SiftUp(static_cast<int>(myHeap.size()) - 1);
+}
+
+template<int Arity>
+inline bool IndexedHeapOpenList<Arity>::Pop(CellCost& outCell)
+{
+	if (myHeap.empty())
+	{
+		return false;
+	}
+
+	outCell = myHeap.front().cell;
+	myPositions[myHeap.front().index] = -1;
+
+	const Entry last = myHeap.back();
+	myHeap.pop_back();
+
+	if (!myHeap.empty())
+	{
+		Place(last, 0);
+		SiftDown(0);
+	}
+
+	return true;
+}
+
+// CellCost's operator< is reversed for the standard heaps, a < b means that b comes first
+template<int Arity>
+inline void IndexedHeapOpenList<Arity>::SiftUp(int aPosition)
+{
+	const Entry entry = myHeap[aPosition];
+
+	while (aPosition > 0)
+	{
+		const int parent = (aPosition - 1) / Arity;
+		if (!(myHeap[parent].cell < entry.cell))
+		{
+			break;
+		}
+
+		Place(myHeap[parent], aPosition);
+		aPosition = parent;
+	}
+
+	Place(entry, aPosition);
+}
+
+template<int Arity>
+inline void IndexedHeapOpenList<Arity>::SiftDown(int aPosition)
+{
+	const Entry entry = myHeap[aPosition];
+	const int size = static_cast<int>(myHeap.size());
+
+	for (;;)
+	{
+		const int firstChild = aPosition * Arity + 1;
+		if (firstChild >= size)
+		{
+			break;
+		}
+
+		int best = firstChild;
+		const int lastChild = std::min(firstChild + Arity, size);
+		for (int child = firstChild + 1; child < lastChild; ++child)
+		{
+			if (myHeap[best].cell < myHeap[child].cell)
+			{
+				best = child;
+			}
+		}
+
+		if (!(entry.cell < myHeap[best].cell))
+		{
+			break;
+		}
+
+		Place(myHeap[best], aPosition);
+		aPosition = best;
+	}
+
+	Place(entry, aPosition);
+}
+
+
+/*
+	One bucket per total cost for integer costs. With a consistent heuristic the popped cost never goes down,
+	so the cheapest bucket is found by walking forward from the last one. Cells in the same bucket come out newest first.
+	Every cost up to the largest one pushed has a bucket, so it suits costs with a small range like UniformCostPolicy's.
+*/
+class BucketOpenList
+{
+
+	public:
+		inline void Clear(const size_t aCellCount)
+		{
+			for (int bucket = myLowest; bucket <= myHighest; ++bucket)
+			{
+				for (const Entry& entry : myBuckets[bucket])
+				{
+					myPositions[entry.index] = -1;
+				}
+
+				myBuckets[bucket].clear();
+			}
+
+			if (myPositions.size() < aCellCount)
+			{
+				myPositions.resize(aCellCount, -1);
+				myCellBuckets.resize(aCellCount, 0);
+			}
+
+			myLowest = INT_MAX;
+			myHighest = -1;
+			myCount = 0;
+		}
+
+		inline void Push(const CellCost& aCell, const int aIndex)
+		{
+			if (myPositions[aIndex] != -1)
+			{
+				Remove(aIndex);
+			}
+
+			const int bucket = aCell.Cost();
+			if (bucket >= static_cast<int>(myBuckets.size()))
+			{
+				myBuckets.resize(bucket + 1);
+			}
+
+			myBuckets[bucket].push_back({ aCell, aIndex });
+			myPositions[aIndex] = static_cast<int>(myBuckets[bucket].size()) - 1;
+			myCellBuckets[aIndex] = bucket;
+
+			myLowest = std::min(myLowest, bucket);
+			myHighest = std::max(myHighest, bucket);
+			++myCount;
+		}
+
+		inline bool Pop(CellCost& outCell)
+		{
+			if (myCount == 0)
+			{
+				return false;
+			}
+
+			while (myBuckets[myLowest].empty())
+			{
+				++myLowest;
+			}
+
+			const Entry entry = myBuckets[myLowest].back();
+			myBuckets[myLowest].pop_back();
+			myPositions[entry.index] = -1;
+			--myCount;
+
+			outCell = entry.cell;
+			return true;
+		}
+
+		inline size_t Size() const { return myCount; }
+
+	private:
+		struct Entry
+		{
+			CellCost cell;
+			int index;
+		};
+
+		// Swaps the last entry of the bucket into the cell's place
+		inline void Remove(const int aIndex)
+		{
+			std::vector<Entry>& bucket = myBuckets[myCellBuckets[aIndex]];
+			const int position = myPositions[aIndex];
+
+			bucket[position] = bucket.back();
+			myPositions[bucket[position].index] = position;
+			bucket.pop_back();
+
+			myPositions[aIndex] = -1;
+			--myCount;
+		}
+
+	private:
+		std::vector<std::vector<Entry>> myBuckets;
+
+		// Position of each cell in its bucket, -1 when it is not in the list
+		std::vector<int> myPositions;
+		std::vector<int> myCellBuckets;
+
+		int myLowest = INT_MAX;
+		int myHighest = -1;
+		size_t myCount = 0;
+
+};
@@ -0,0 +1,440 @@
+#include "PathBenchmark.h"
+
+#include <cmath>
+#include <random>
+#include <chrono>
+#include <fstream>
+#include <algorithm>
+
+int PathBenchmark::AddMovingAIDirectory(const std::filesystem::path& aDirectory, const int aMaxQueriesPerMap)
+{
+	if (!std::filesystem::is_directory(aDirectory))
+	{
+		return 0;
+	}
+
+	// Sorted so the maps run in the same order on every machine
+	std::vector<std::filesystem::path> mapPaths;
+	for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(aDirectory))
+	{
+		if (entry.is_regular_file() && entry.path().extension() == ".map")
+		{
+			mapPaths.push_back(entry.path());
+		}
+	}
+
+	std::sort(mapPaths.begin(), mapPaths.end());
+
+	int addedCount = 0;
+	for (const std::filesystem::path& mapPath : mapPaths)
+	{
+		std::filesystem::path scenarioPath = mapPath;
+		scenarioPath += ".scen";
+
+		BenchmarkMap map;
+		map.name = mapPath.filename().string();
+
+		if (!LoadMovingAIMap(mapPath, map.grid) || !LoadMovingAIScenario(scenarioPath, map.grid, map.queries, aMaxQueriesPerMap))
+		{
+			continue;
+		}
+
+		myMaps.push_back(std::move(map));
+		++addedCount;
+	}
+
+	return addedCount;
+}
+
+bool PathBenchmark::LoadMovingAIMap(const std::filesystem::path& aPath, NavigationGrid<>& outGrid)
+{
+	std::ifstream file(aPath);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	int width = 0;
+	int height = 0;
+
+	// The header is "type octile", "height", "width" and "map" on their own lines
+	std::string word;
+	while (file >> word && word != "map")
+	{
+		if (word == "height")
+		{
+			file >> height;
+		}
+		else if (word == "width")
+		{
+			file >> width;
+		}
+	}
+
+	if (width <= 0 || height <= 0)
+	{
+		return false;
+	}
+
+	outGrid.Resize(width, height);
+
+	std::string row;
+	for (int y = 0; y < height; ++y)
+	{
+		if (!(file >> row) || static_cast<int>(row.size()) < width)
+		{
+			return false;
+		}
+
+		for (int x = 0; x < width; ++x)
+		{
+			const char cell = row[x];
+			outGrid.SetWalkable(GridLocation(x, y), cell == '.' || cell == 'G' || cell == 'S');
+		}
+	}
+
+	return true;
+}
+
+bool PathBenchmark::LoadMovingAIScenario(const std::filesystem::path& aPath, const NavigationGrid<>& aGrid, std::vector<BenchmarkQuery>& outQueries, const int aMaxQueries)
+{
+	std::ifstream file(aPath);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	std::string version;
+	std::getline(file, version);
+
+	// Bucket, map, map width, map height, start x, start y, goal x, goal y and the optimal length
+	int bucket;
+	std::string mapName;
+	int width;
+	int height;
+	BenchmarkQuery query;
+
+	while (static_cast<int>(outQueries.size()) < aMaxQueries &&
+		file >> bucket >> mapName >> width >> height >> query.start.x >> query.start.y >> query.goal.x >> query.goal.y >> query.optimalLength)
+	{
+		if (width != aGrid.GetWidth() || height != aGrid.GetHeight())
+		{
+			outQueries.clear();
+			return false;
+		}
+
+		const bool inside = query.start.x >= 0 && query.start.y >= 0 && query.start.x < width && query.start.y < height &&
+			query.goal.x >= 0 && query.goal.y >= 0 && query.goal.x < width && query.goal.y < height;
+
+		if (inside && aGrid.IsWalkable(query.start.x, query.start.y) && aGrid.IsWalkable(query.goal.x, query.goal.y))
+		{
+			outQueries.push_back(query);
+		}
+	}
+
+	return !outQueries.empty();
+}
+
+void PathBenchmark::AddMaze(const int aWidth, const int aHeight, const uint32_t aSeed, const int aQueryCount)
+{
+	BenchmarkMap map;
+	map.name = "maze" + std::to_string(aWidth) + "x" + std::to_string(aHeight) + "-" + std::to_string(aSeed);
+	map.grid.Resize(aWidth, aHeight);
+
+	// Rooms on odd cells, the walls between them are opened by a depth first walk
+	const int roomColumns = (aWidth - 1) / 2;
+	const int roomRows = (aHeight - 1) / 2;
+
+	if (roomColumns > 0 && roomRows > 0)
+	{
+		std::mt19937 random(aSeed);
+		std::vector<bool> visited(static_cast<size_t>(roomColumns) * roomRows, false);
+		std::vector<int> stack = { 0 };
+
+		visited[0] = true;
+		map.grid.SetWalkable(GridLocation(1, 1), true);
+
+		while (!stack.empty())
+		{
+			const int room = stack.back();
+			const int column = room % roomColumns;
+			const int row = room / roomColumns;
+
+			int unvisited[4];
+			int unvisitedCount = 0;
+
+			constexpr int offsetX[4] = { 0, 1, 0, -1 };
+			constexpr int offsetY[4] = { -1, 0, 1, 0 };
+
+			for (int direction = 0; direction < 4; ++direction)
+			{
+				const int nextColumn = column + offsetX[direction];
+				const int nextRow = row + offsetY[direction];
+
+				if (nextColumn >= 0 && nextRow >= 0 && nextColumn < roomColumns && nextRow < roomRows && !visited[nextRow * roomColumns + nextColumn])
+				{
+					unvisited[unvisitedCount++] = direction;
+				}
+			}
+
+			if (unvisitedCount == 0)
+			{
+				stack.pop_back();
+				continue;
+			}
+
+			const int direction = unvisited[random() % unvisitedCount];
+			const int next = (row + offsetY[direction]) * roomColumns + column + offsetX[direction];
+
+			map.grid.SetWalkable(GridLocation(column * 2 + 1 + offsetX[direction], row * 2 + 1 + offsetY[direction]), true);
+			map.grid.SetWalkable(GridLocation((next % roomColumns) * 2 + 1, (next / roomColumns) * 2 + 1), true);
+
+			visited[next] = true;
+			stack.push_back(next);
+		}
+	}
+
+	AddRandomQueries(map, aSeed, aQueryCount);
+	myMaps.push_back(std::move(map));
+}
+
+void PathBenchmark::AddOpenField(const int aWidth, const int aHeight, const uint32_t aSeed, const int aQueryCount)
+{
+	AddRandomObstacles(aWidth, aHeight, 0.0f, aSeed, aQueryCount);
+	myMaps.back().name = "open" + std::to_string(aWidth) + "x" + std::to_string(aHeight) + "-" + std::to_string(aSeed);
+}
+
+void PathBenchmark::AddRandomObstacles(const int aWidth, const int aHeight, const float aDensity, const uint32_t aSeed, const int aQueryCount)
+{
+	BenchmarkMap map;
+	map.name = "random" + std::to_string(aWidth) + "x" + std::to_string(aHeight) + "-" + std::to_string(static_cast<int>(aDensity * 100.0f)) + "-" + std::to_string(aSeed);
+	map.grid.Resize(aWidth, aHeight);
+
+	std::mt19937 random(aSeed);
+	std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+
+	for (int y = 0; y < aHeight; ++y)
+	{
+		for (int x = 0; x < aWidth; ++x)
+		{
+			map.grid.SetWalkable(GridLocation(x, y), distribution(random) >= aDensity);
+		}
+	}
+
+	AddRandomQueries(map, aSeed, aQueryCount);
+	myMaps.push_back(std::move(map));
+}
+
+void PathBenchmark::Run()
+{
+	myResults.clear();
+
+	constexpr eSearchMode searchModes[] = { eSearchMode::Neighbors, eSearchMode::Bidirectional, eSearchMode::JumpPoint, eSearchMode::JumpPointPlus, eSearchMode::AnyAngle };
+
+	Search search;
+	for (BenchmarkMap& map : myMaps)
+	{
+		for (const eSearchMode searchMode : searchModes)
+		{
+			myResults.push_back(RunMode(search, map, searchMode));
+		}
+	}
+}
+
+void PathBenchmark::Print(std::ostream& aStream) const
+{
+	aStream << "map\tmode\tqueries\tno path\twrong length\texpanded\tpeak open\tallocations\tmean ns\tp50 ns\tp90 ns\tp99 ns\tmax ns\n";
+
+	for (const BenchmarkResult& result : myResults)
+	{
+		aStream << result.mapName << '\t' << GetSearchModeName(result.searchMode) << '\t' << result.queryCount << '\t' << result.noPathCount << '\t';
+
+		if (result.searchMode != eSearchMode::AnyAngle)
+		{
+			aStream << result.wrongLengthCount;
+		}
+		else
+		{
+			aStream << '-';
+		}
+
+		aStream << '\t' << result.meanExpanded << '\t' << result.peakOpenListSize << '\t';
+
+		if (myAllocationCounter)
+		{
+			aStream << result.allocationsPerQuery;
+		}
+		else
+		{
+			aStream << '-';
+		}
+
+		aStream << '\t' << result.meanTime << '\t' << result.medianTime << '\t' << result.percentile90Time << '\t'
+			<< result.percentile99Time << '\t' << result.maxTime << '\n';
+	}
+}
+
+BenchmarkResult PathBenchmark::RunMode(Search& aSearch, BenchmarkMap& aMap, const eSearchMode aSearchMode)
+{
+	BenchmarkResult result;
+	result.mapName = aMap.name;
+	result.searchMode = aSearchMode;
+	result.queryCount = static_cast<int>(aMap.queries.size());
+
+	aSearch.SetSearchMode(aSearchMode);
+
+	// Preprocessing is not part of the query time
+	if (aSearchMode == eSearchMode::JumpPointPlus)
+	{
+		aSearch.BuildJumpDistances(aMap.grid);
+	}
+
+	if (aMap.queries.empty())
+	{
+		return result;
+	}
+
+	// The first search sizes the scratch for the map, so the timed ones only show what a warm search costs
+	aSearch.FindPath(aMap.grid, aMap.queries.front().start, aMap.queries.front().goal);
+
+	std::vector<int64_t> times;
+	times.reserve(aMap.queries.size());
+
+	int64_t totalExpanded = 0;
+	uint64_t totalAllocations = 0;
+
+	for (const BenchmarkQuery& query : aMap.queries)
+	{
+		const uint64_t allocationsBefore = myAllocationCounter ? myAllocationCounter() : 0;
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		const std::vector<GridLocation> path = aSearch.FindPath(aMap.grid, query.start, query.goal);
+
+		const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+		const uint64_t allocationsAfter = myAllocationCounter ? myAllocationCounter() : 0;
+
+		times.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+		totalAllocations += allocationsAfter - allocationsBefore;
+		totalExpanded += aSearch.GetExpandedCount();
+		result.peakOpenListSize = std::max(result.peakOpenListSize, aSearch.GetPeakOpenListSize());
+
+		if (path.empty() && !(query.start == query.goal))
+		{
+			++result.noPathCount;
+		}
+
+		// Any angle paths are shorter than octile ones
+		if (aSearchMode != eSearchMode::AnyAngle && query.optimalLength >= 0.0)
+		{
+			int cost;
+			const double length = GetPathLength(query.start, path, cost);
+			const double roundedLength = static_cast<double>(cost) / DiagonalCostPolicy::ourStraightCost;
+
+			// A path can tie with the optimal one in cost and still be a little longer, which the searches can not tell apart
+			if (roundedLength > query.optimalLength + ourLengthTolerance || length < query.optimalLength - ourLengthTolerance)
+			{
+				++result.wrongLengthCount;
+			}
+		}
+	}
+
+	const size_t count = times.size();
+	result.meanExpanded = static_cast<double>(totalExpanded) / count;
+	result.allocationsPerQuery = static_cast<double>(totalAllocations) / count;
+
+	int64_t totalTime = 0;
+	for (const int64_t time : times)
+	{
+		totalTime += time;
+	}
+
+	result.meanTime = totalTime / static_cast<int64_t>(count);
+
+	std::sort(times.begin(), times.end());
+	result.medianTime = times[(count - 1) / 2];
+	result.percentile90Time = times[(count - 1) * 90 / 100];
+	result.percentile99Time = times[(count - 1) * 99 / 100];
+	result.maxTime = times.back();
+
+	return result;
+}
+
+void PathBenchmark::AddRandomQueries(BenchmarkMap& aMap, const uint32_t aSeed, const int aQueryCount)
+{
+	std::vector<GridLocation> walkable;
+	for (int y = 0; y < aMap.grid.GetHeight(); ++y)
+	{
+		for (int x = 0; x < aMap.grid.GetWidth(); ++x)
+		{
+			if (aMap.grid.IsWalkable(x, y))
+			{
+				walkable.push_back(GridLocation(x, y));
+			}
+		}
+	}
+
+	if (walkable.empty())
+	{
+		return;
+	}
+
+	Search search;
+	search.SetSearchMode(eSearchMode::Neighbors);
+
+	std::mt19937 random(aSeed);
+	for (int i = 0; i < aQueryCount; ++i)
+	{
+		BenchmarkQuery query;
+		query.start = walkable[random() % walkable.size()];
+		query.goal = walkable[random() % walkable.size()];
+
+		const std::vector<GridLocation> path = search.FindPath(aMap.grid, query.start, query.goal);
+		if (!path.empty() || query.start == query.goal)
+		{
+			int cost;
+			GetPathLength(query.start, path, cost);
+			query.optimalLength = static_cast<double>(cost) / DiagonalCostPolicy::ourStraightCost;
+		}
+
+		aMap.queries.push_back(query);
+	}
+}
+
+double PathBenchmark::GetPathLength(const GridLocation& aStartLocation, const std::vector<GridLocation>& aPath, int& outCost)
+{
+	// Goal first, so the steps are walked from the back
+	double length = 0.0;
+	outCost = 0;
+	GridLocation previous = aStartLocation;
+
+	for (auto it = aPath.rbegin(); it != aPath.rend(); ++it)
+	{
+		const int dx = std::abs(it->x - previous.x);
+		const int dy = std::abs(it->y - previous.y);
+
+		length += std::max(dx, dy) + (std::sqrt(2.0) - 1.0) * std::min(dx, dy);
+		outCost += DiagonalCostPolicy::GetHeuristic(previous, *it);
+		previous = *it;
+	}
+
+	return length;
+}
+
+const char* PathBenchmark::GetSearchModeName(const eSearchMode aSearchMode)
+{
+	switch (aSearchMode)
+	{
+		case eSearchMode::Neighbors:
+			return "Neighbors";
+		case eSearchMode::JumpPoint:
+			return "JumpPoint";
+		case eSearchMode::JumpPointPlus:
+			return "JumpPointPlus";
+		case eSearchMode::Bidirectional:
+			return "Bidirectional";
+		case eSearchMode::AnyAngle:
+			return "AnyAngle";
+	}
+
+	return "Unknown";
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "AStar.h"
+#include "NavigationGrid.h"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <ostream>
+#include <filesystem>
+
+/*
+	Usage:
+
+	PathBenchmark benchmark;
+	benchmark.AddMovingAIDirectory("Maps/MovingAI");
+	benchmark.AddMaze(256, 256, 1, 1000);
+	benchmark.Run();
+	benchmark.Print(std::cout);
+
+	Allocations are only counted when the executable replaces the global operator new and hands its counter to SetAllocationCounter.
+*/
+
+struct BenchmarkQuery
+{
+	GridLocation start;
+	GridLocation goal;
+
+	// Octile length with diagonals of sqrt(2), -1 when it is not known.
+	// Generated maps use the cost of a Neighbors search over ten instead, where a diagonal is 1.4.
+	double optimalLength = -1.0;
+};
+
+struct BenchmarkMap
+{
+	std::string name;
+	NavigationGrid<> grid;
+	std::vector<BenchmarkQuery> queries;
+};
+
+struct BenchmarkResult
+{
+	std::string mapName;
+	eSearchMode searchMode;
+
+	int queryCount = 0;
+	int noPathCount = 0;
+
+	// Paths longer or shorter than the optimal length of the query, AnyAngle paths are not checked.
+	// The searches count a diagonal as 1.4, so a path is only too long when its cost over ten is above the optimal length.
+	int wrongLengthCount = 0;
+
+	double meanExpanded = 0.0;
+	size_t peakOpenListSize = 0;
+	double allocationsPerQuery = 0.0;
+
+	// Nanoseconds per query
+	int64_t meanTime = 0;
+	int64_t medianTime = 0;
+	int64_t percentile90Time = 0;
+	int64_t percentile99Time = 0;
+	int64_t maxTime = 0;
+};
+
+
+/*
+	Runs every search mode of AStar over a set of maps and reports expansions, open list size, allocations and time per query.
+	Maps come from the MovingAI benchmark format, .map for the grid and .map.scen for the queries, or are generated from a seed
+	so runs can be compared. Every mode uses DiagonalCostPolicy on a NavigationGrid since the MovingAI maps are octile.
+	Every path is checked against the optimal length of its query, so a faster mode that returns longer paths shows up.
+*/
+class PathBenchmark
+{
+
+	public:
+		// Loads every .map in the directory that has a .map.scen next to it, returns the number of maps added
+		int AddMovingAIDirectory(const std::filesystem::path& aDirectory, const int aMaxQueriesPerMap = INT_MAX);
+
+		// Only '.', 'G' and 'S' are walkable, the rest are walls, trees, water or out of bounds
+		static bool LoadMovingAIMap(const std::filesystem::path& aPath, NavigationGrid<>& outGrid);
+
+		// Fails when the scenario was made for a map of another size, queries outside the grid or on blocked cells are skipped
+		static bool LoadMovingAIScenario(const std::filesystem::path& aPath, const NavigationGrid<>& aGrid, std::vector<BenchmarkQuery>& outQueries, const int aMaxQueries = INT_MAX);
+
+		// Corridors one cell wide with a single route between any two cells
+		void AddMaze(const int aWidth, const int aHeight, const uint32_t aSeed, const int aQueryCount);
+		void AddOpenField(const int aWidth, const int aHeight, const uint32_t aSeed, const int aQueryCount);
+
+		// aDensity is the share of cells that are blocked, from 0 to 1
+		void AddRandomObstacles(const int aWidth, const int aHeight, const float aDensity, const uint32_t aSeed, const int aQueryCount);
+
+		void Run();
+		void Print(std::ostream& aStream) const;
+
+		inline void SetAllocationCounter(uint64_t (*aAllocationCounter)()) { myAllocationCounter = aAllocationCounter; }
+
+		inline const std::vector<BenchmarkMap>& GetMaps() const { return myMaps; }
+		inline const std::vector<BenchmarkResult>& GetResults() const { return myResults; }
+
+	private:
+		using Search = AStar<DiagonalCostPolicy, NavigationGrid<>>;
+
+		// The MovingAI scenarios write their lengths with eight decimals
+		static constexpr double ourLengthTolerance = 0.0001;
+
+		BenchmarkResult RunMode(Search& aSearch, BenchmarkMap& aMap, const eSearchMode aSearchMode);
+
+		// Start and goal on random walkable cells, the same seed gives the same queries.
+		// The optimal lengths come from a Neighbors search, so the other modes are checked against it.
+		static void AddRandomQueries(BenchmarkMap& aMap, const uint32_t aSeed, const int aQueryCount);
+
+		// Octile length from the start through every cell of a path shaped like the ones AStar returns, and its cost in DiagonalCostPolicy units
+		static double GetPathLength(const GridLocation& aStartLocation, const std::vector<GridLocation>& aPath, int& outCost);
+
+		static const char* GetSearchModeName(const eSearchMode aSearchMode);
+
+	private:
+		std::vector<BenchmarkMap> myMaps;
+		std::vector<BenchmarkResult> myResults;
+
+		uint64_t (*myAllocationCounter)() = nullptr;
+
+};
@@ -0,0 +1,224 @@
+#include "PathCache.h"
+
+#include <algorithm>
+
+PathCache::PathCache(const int aRegionSize, const size_t aCapacity) : myRegionSize(aRegionSize), myCapacity(aCapacity), mySpliceExpansionLimit(aRegionSize * aRegionSize * 4)
+{
+}
+
+std::vector<GridLocation> PathCache::FindPath(AStar<>& aSearch, Grid& aSearchGrid, GridLocation aStartLocation, GridLocation aGoalLocation)
+{
+	if (aStartLocation == aGoalLocation)
+	{
+		return {};
+	}
+
+	const uint64_t key = GetKey(aSearchGrid, aStartLocation, aGoalLocation);
+
+	// Copied so the searches below run without the lock
+	Entry cached;
+	bool found = false;
+	{
+		std::lock_guard<std::mutex> lock(myLock);
+
+		auto entry = myEntryLookup.find(key);
+		if (entry != myEntryLookup.end())
+		{
+			myEntries.splice(myEntries.begin(), myEntries, entry->second);
+			cached = *entry->second;
+			found = true;
+		}
+	}
+
+	if (found)
+	{
+		// Goal first, then the cached path and the way from the start onto it
+		std::vector<GridLocation> path;
+		bool spliced = true;
+
+		if (!(cached.goal == aGoalLocation))
+		{
+			spliced = FindSplice(aSearch, aSearchGrid, cached.goal, aGoalLocation, path);
+		}
+
+		if (spliced)
+		{
+			path.insert(path.end(), cached.path.begin(), cached.path.end());
+
+			if (!(cached.start == aStartLocation))
+			{
+				std::vector<GridLocation> toCachedStart;
+				spliced = FindSplice(aSearch, aSearchGrid, aStartLocation, cached.start, toCachedStart);
+
+				path.insert(path.end(), toCachedStart.begin(), toCachedStart.end());
+			}
+		}
+
+		if (spliced)
+		{
+			++myHitCount;
+
+			RemoveLoops(aStartLocation, path);
+			return path;
+		}
+	}
+
+	++myMissCount;
+
+	std::vector<GridLocation> path = aSearch.FindPath(aSearchGrid, aStartLocation, aGoalLocation);
+	if (!path.empty())
+	{
+		Insert(key, aStartLocation, aGoalLocation, path);
+	}
+
+	return path;
+}
+
+void PathCache::InvalidateCell(const GridLocation& aLocation)
+{
+	std::lock_guard<std::mutex> lock(myLock);
+
+	auto cell = myCellEntries.find(aLocation);
+	if (cell == myCellEntries.end())
+	{
+		return;
+	}
+
+	// Copied since removing the entries edits the list
+	const std::vector<uint64_t> keys = cell->second;
+	for (const uint64_t key : keys)
+	{
+		auto entry = myEntryLookup.find(key);
+		if (entry != myEntryLookup.end())
+		{
+			Remove(entry->second);
+		}
+	}
+}
+
+void PathCache::Clear()
+{
+	std::lock_guard<std::mutex> lock(myLock);
+
+	myEntries.clear();
+	myEntryLookup.clear();
+	myCellEntries.clear();
+}
+
+size_t PathCache::Size() const
+{
+	std::lock_guard<std::mutex> lock(myLock);
+	return myEntries.size();
+}
+
+bool PathCache::FindSplice(AStar<>& aSearch, Grid& aSearchGrid, const GridLocation& aStartLocation, const GridLocation& aGoalLocation, std::vector<GridLocation>& outPath) const
+{
+	aSearch.StartSearch(aSearchGrid, aStartLocation, aGoalLocation);
+	if (aSearch.Step(mySpliceExpansionLimit) != eSearchStatus::Found)
+	{
+		return false;
+	}
+
+	outPath = aSearch.GetPath();
+	return true;
+}
+
+uint64_t PathCache::GetKey(Grid& aSearchGrid, const GridLocation& aStartLocation, const GridLocation& aGoalLocation) const
+{
+	const int regionColumns = (aSearchGrid.GetWidth() + myRegionSize - 1) / myRegionSize;
+
+	const uint32_t startRegion = static_cast<uint32_t>((aStartLocation.y / myRegionSize) * regionColumns + aStartLocation.x / myRegionSize);
+	const uint32_t goalRegion = static_cast<uint32_t>((aGoalLocation.y / myRegionSize) * regionColumns + aGoalLocation.x / myRegionSize);
+
+	return static_cast<uint64_t>(startRegion) << 32 | goalRegion;
+}
+
+void PathCache::Insert(const uint64_t aKey, const GridLocation& aStartLocation, const GridLocation& aGoalLocation, const std::vector<GridLocation>& aPath)
+{
+	std::lock_guard<std::mutex> lock(myLock);
+
+	// Another thread may have cached the same regions while this one searched
+	auto existing = myEntryLookup.find(aKey);
+	if (existing != myEntryLookup.end())
+	{
+		Remove(existing->second);
+	}
+
+	myEntries.push_front({ aKey, aStartLocation, aGoalLocation, aPath });
+	myEntryLookup[aKey] = myEntries.begin();
+
+	for (const GridLocation& location : aPath)
+	{
+		myCellEntries[location].push_back(aKey);
+	}
+
+	while (myEntries.size() > myCapacity)
+	{
+		Remove(std::prev(myEntries.end()));
+	}
+}
+
+void PathCache::Remove(std::list<Entry>::iterator aEntry)
+{
+	for (const GridLocation& location : aEntry->path)
+	{
+		auto cell = myCellEntries.find(location);
+		if (cell == myCellEntries.end())
+		{
+			continue;
+		}
+
+		std::vector<uint64_t>& keys = cell->second;
+
+		// A path that visits a cell twice also has two keys there, only one is removed per visit
+		auto key = std::find(keys.begin(), keys.end(), aEntry->key);
+		if (key != keys.end())
+		{
+			*key = keys.back();
+			keys.pop_back();
+		}
+
+		if (keys.empty())
+		{
+			myCellEntries.erase(cell);
+		}
+	}
+
+	myEntryLookup.erase(aEntry->key);
+	myEntries.erase(aEntry);
+}
+
+void PathCache::RemoveLoops(const GridLocation& aStartLocation, std::vector<GridLocation>& outPath)
+{
+	std::unordered_map<GridLocation, int, GridLocation::HashFunction> positions;
+	std::vector<GridLocation> path;
+	path.reserve(outPath.size());
+
+	// Walking from the goal, coming back to a cell drops everything since its first visit
+	for (const GridLocation& location : outPath)
+	{
+		auto visited = positions.find(location);
+		if (visited == positions.end())
+		{
+			positions[location] = static_cast<int>(path.size());
+			path.push_back(location);
+			continue;
+		}
+
+		for (size_t i = visited->second + 1; i < path.size(); ++i)
+		{
+			positions.erase(path[i]);
+		}
+
+		path.resize(visited->second + 1);
+	}
+
+	// The start is left out of paths, so passing through it ends the path there
+	auto start = positions.find(aStartLocation);
+	if (start != positions.end())
+	{
+		path.resize(start->second);
+	}
+
+	outPath = std::move(path);
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "AStar.h"
+
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+class Grid;
+
+
+/*
+	LRU cache of paths in front of AStar, keyed by the coarse regions of the start and the goal.
+	A hit reuses the cached path and only searches from the start to the cached start and from the cached goal to the goal,
+	which are in the same regions, any loops the splice makes are cut out. Those searches stop after a few regions' worth
+	of expansions, so a wall between the two cells can not make a hit search the whole map, it counts as a miss instead.
+	A spliced path is not the shortest path and can be much longer than a fresh search, for example when the start and
+	goal are closer to each other than to the cached path.
+	Every cell of a cached path knows the entries passing through it, so blocking a cell only drops the paths that use it.
+	Lookups can come from several threads, each with its own AStar. The grid must not change during a lookup.
+*/
+class PathCache
+{
+
+	public:
+		PathCache(const int aRegionSize = 8, const size_t aCapacity = 256);
+
+		// Same path shape as AStar::FindPath
+		std::vector<GridLocation> FindPath(AStar<>& aSearch, Grid& aSearchGrid, GridLocation aStartLocation, GridLocation aGoalLocation);
+
+		// Call when a cell stops being walkable, cells that open up leave the cached paths valid
+		void InvalidateCell(const GridLocation& aLocation);
+
+		void Clear();
+
+		size_t Size() const;
+
+		// Expansions allowed for each of the two short searches of a hit, four regions by default
+		inline void SetSpliceExpansionLimit(const int aLimit) { mySpliceExpansionLimit = aLimit; }
+		inline int GetSpliceExpansionLimit() const { return mySpliceExpansionLimit; }
+
+		inline uint64_t GetHitCount() const { return myHitCount; }
+		inline uint64_t GetMissCount() const { return myMissCount; }
+		inline void ResetCounters() { myHitCount = 0; myMissCount = 0; }
+
+	private:
+		struct Entry
+		{
+			uint64_t key;
+
+			GridLocation start;
+			GridLocation goal;
+			std::vector<GridLocation> path;
+		};
+
+		// Path from aStartLocation to aGoalLocation within the splice expansion limit, false when it was not found in time
+		bool FindSplice(AStar<>& aSearch, Grid& aSearchGrid, const GridLocation& aStartLocation, const GridLocation& aGoalLocation, std::vector<GridLocation>& outPath) const;
+
+		uint64_t GetKey(Grid& aSearchGrid, const GridLocation& aStartLocation, const GridLocation& aGoalLocation) const;
+
+		void Insert(const uint64_t aKey, const GridLocation& aStartLocation, const GridLocation& aGoalLocation, const std::vector<GridLocation>& aPath);
+
+		// Expects myLock to be held
+		void Remove(std::list<Entry>::iterator aEntry);
+
+		// Cuts the loops out of a spliced path, including any pass through the start
+		static void RemoveLoops(const GridLocation& aStartLocation, std::vector<GridLocation>& outPath);
+
+	private:
+		// Most recently used first
+		std::list<Entry> myEntries;
+		std::unordered_map<uint64_t, std::list<Entry>::iterator> myEntryLookup;
+
+		// Keys of the entries whose path goes through the cell
+		std::unordered_map<GridLocation, std::vector<uint64_t>, GridLocation::HashFunction> myCellEntries;
+
+		mutable std::mutex myLock;
+
+		std::atomic<uint64_t> myHitCount = 0;
+		std::atomic<uint64_t> myMissCount = 0;
+
+		int myRegionSize;
+		size_t myCapacity;
+		int mySpliceExpansionLimit;
+
+};
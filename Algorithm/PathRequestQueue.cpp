@@ -0,0 +1,165 @@
+#include "PathRequestQueue.h"
+
+#include <atomic>
+#include <memory>
+#include <cassert>
+#include <algorithm>
+
+PathRequestQueue::PathRequestQueue(ThreadPool& aThreadPool) : myThreadPool(aThreadPool)
+{
+}
+
+PathRequestQueue::~PathRequestQueue()
+{
+	// Workers still hold a pointer to this
+	WaitForDispatched();
+}
+
+std::future<std::vector<GridLocation>> PathRequestQueue::Submit(const GridLocation& aStartLocation, const GridLocation& aGoalLocation)
+{
+	PathRequest request;
+	request.start = aStartLocation;
+	request.goal = aGoalLocation;
+
+	std::future<std::vector<GridLocation>> future = request.promise.get_future();
+
+	std::lock_guard<std::mutex> lock(myPendingLock);
+	myPendingRequests.push_back(std::move(request));
+
+	return future;
+}
+
+void PathRequestQueue::Submit(const GridLocation& aStartLocation, const GridLocation& aGoalLocation, std::function<void(std::vector<GridLocation>&)> aCallback)
+{
+	PathRequest request;
+	request.start = aStartLocation;
+	request.goal = aGoalLocation;
+	request.callback = std::move(aCallback);
+
+	std::lock_guard<std::mutex> lock(myPendingLock);
+	myPendingRequests.push_back(std::move(request));
+}
+
+void PathRequestQueue::Update(Grid& aSearchGrid)
+{
+	// Shared by the workers of this dispatch, each one takes the next unclaimed request
+	struct Dispatch
+	{
+		PathRequestQueue* queue;
+		std::vector<PathRequest> requests;
+		std::atomic<size_t> next = 0;
+
+		// Runs after the last worker is done, or when the thread pool is destroyed with the tasks still queued.
+		// The requests no worker took are settled here and their futures get a broken promise.
+		~Dispatch()
+		{
+			const size_t unclaimed = requests.size() - std::min(next.load(), requests.size());
+			if (unclaimed > 0)
+			{
+				queue->FinishRequests(static_cast<int>(unclaimed));
+			}
+		}
+	};
+
+	// Settles one claimed request even when the search or the callback throws
+	struct FinishedRequest
+	{
+		PathRequestQueue* queue;
+
+		~FinishedRequest()
+		{
+			queue->FinishRequests(1);
+		}
+	};
+
+	auto dispatch = std::make_shared<Dispatch>();
+	dispatch->queue = this;
+	{
+		std::lock_guard<std::mutex> lock(myPendingLock);
+
+		const size_t count = std::min(myPendingRequests.size(), static_cast<size_t>(std::max(myRequestsPerTick, 0)));
+		dispatch->requests.reserve(count);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			dispatch->requests.push_back(std::move(myPendingRequests.front()));
+			myPendingRequests.pop_front();
+		}
+	}
+
+	if (dispatch->requests.empty())
+	{
+		return;
+	}
+
+	assert(myThreadPool.Size() > 0 && "The thread pool has no workers");
+
+	{
+		std::lock_guard<std::mutex> lock(myInFlightLock);
+		myInFlightCount += static_cast<int>(dispatch->requests.size());
+	}
+
+	const size_t workerCount = std::min(myThreadPool.Size(), dispatch->requests.size());
+	for (size_t worker = 0; worker < workerCount; ++worker)
+	{
+		myThreadPool.AddWork([dispatch, searchGrid = &aSearchGrid, searchMode = mySearchMode]()
+		{
+			static thread_local AStar<> search;
+			search.SetSearchMode(searchMode);
+
+			for (size_t i = dispatch->next++; i < dispatch->requests.size(); i = dispatch->next++)
+			{
+				PathRequest& request = dispatch->requests[i];
+				FinishedRequest finished{ dispatch->queue };
+
+				if (request.callback)
+				{
+					std::vector<GridLocation> path = search.FindPath(*searchGrid, request.start, request.goal);
+					request.callback(path);
+					continue;
+				}
+
+				try
+				{
+					request.promise.set_value(search.FindPath(*searchGrid, request.start, request.goal));
+				}
+				catch (...)
+				{
+					request.promise.set_exception(std::current_exception());
+				}
+			}
+		});
+	}
+}
+
+void PathRequestQueue::WaitForDispatched()
+{
+	std::unique_lock<std::mutex> lock(myInFlightLock);
+	myInFlightCondition.wait(lock, [this]() { return myInFlightCount == 0; });
+}
+
+void PathRequestQueue::SetSearchMode(const eSearchMode aSearchMode)
+{
+	assert(aSearchMode != eSearchMode::JumpPointPlus && "Jump distances can not be shared between the workers");
+	mySearchMode = aSearchMode;
+}
+
+size_t PathRequestQueue::GetPendingCount() const
+{
+	std::lock_guard<std::mutex> lock(myPendingLock);
+	return myPendingRequests.size();
+}
+
+int PathRequestQueue::GetInFlightCount() const
+{
+	std::lock_guard<std::mutex> lock(myInFlightLock);
+	return myInFlightCount;
+}
+
+void PathRequestQueue::FinishRequests(const int aCount)
+{
+	// Notified under the lock, a waiting destructor could otherwise destroy the condition before the call
+	std::lock_guard<std::mutex> lock(myInFlightLock);
+	myInFlightCount -= aCount;
+	myInFlightCondition.notify_all();
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "AStar.h"
+#include "../Pool/Thread/ThreadPool.h"
+
+#include <deque>
+#include <future>
+#include <mutex>
+#include <functional>
+#include <condition_variable>
+
+class Grid;
+
+struct PathRequest
+{
+	GridLocation start;
+	GridLocation goal;
+
+	// Fulfilled when there is no callback
+	std::promise<std::vector<GridLocation>> promise;
+	std::function<void(std::vector<GridLocation>&)> callback;
+};
+
+
+/*
+	Collects path requests during a tick and runs them on the thread pool in Update.
+	Every worker searches with its own thread local AStar, so the search scratch is only allocated the first time a worker
+	sees a grid of that size. Workers take the next request from a shared counter, so a few long searches do not leave
+	the other workers idle.
+	The grid must not change while requests are in flight, WaitForDispatched blocks until they are done.
+	The thread pool has to keep running until then. Destroying it with requests still queued counts them as done
+	and gives their futures a broken promise, but a pool that is terminated and kept alive makes WaitForDispatched wait forever.
+*/
+class PathRequestQueue
+{
+
+	public:
+		PathRequestQueue(ThreadPool& aThreadPool);
+		~PathRequestQueue();
+
+		// A search that throws stores the exception in the future
+		std::future<std::vector<GridLocation>> Submit(const GridLocation& aStartLocation, const GridLocation& aGoalLocation);
+
+		// The callback runs on the worker thread that found the path and must not throw
+		void Submit(const GridLocation& aStartLocation, const GridLocation& aGoalLocation, std::function<void(std::vector<GridLocation>&)> aCallback);
+
+		// Starts at most the per tick budget of the oldest requests, the rest wait for the next update
+		void Update(Grid& aSearchGrid);
+
+		void WaitForDispatched();
+
+		// JumpPointPlus is not supported since the jump distances belong to one AStar
+		void SetSearchMode(const eSearchMode aSearchMode);
+		inline eSearchMode GetSearchMode() const { return mySearchMode; }
+
+		inline void SetRequestsPerTick(const int aRequestsPerTick) { myRequestsPerTick = aRequestsPerTick; }
+		inline int GetRequestsPerTick() const { return myRequestsPerTick; }
+
+		size_t GetPendingCount() const;
+		int GetInFlightCount() const;
+
+	private:
+		void FinishRequests(const int aCount);
+
+	private:
+		ThreadPool& myThreadPool;
+
+		std::deque<PathRequest> myPendingRequests;
+		mutable std::mutex myPendingLock;
+
+		int myInFlightCount = 0;
+		mutable std::mutex myInFlightLock;
+		std::condition_variable myInFlightCondition;
+
+		eSearchMode mySearchMode = eSearchMode::Neighbors;
+		int myRequestsPerTick = 256;
+
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "GridLocation.h"
+
+#include <vector>
+#include <cstdlib>
+
+/*
+	Straight line checks over a grid and string pulling of the paths AStar returns.
+	A line is walked cell by cell from the center of one cell to the center of the other, like a DDA with integer steps.
+	Every cell the line touches has to be walkable, and a line through the corner of four cells needs both cells beside
+	the corner, the same rule AStar uses for diagonal steps.
+*/
+struct PathSmoothing
+{
+	template<class SearchGrid>
+	static bool HasLineOfSight(SearchGrid& aSearchGrid, const GridLocation& aFrom, const GridLocation& aTo);
+
+	// Drops every cell of the path that the cells before and after it can see past, aStartLocation is the cell the path leaves from.
+	// Works on any path shape AStar returns, from the goal back to the first step, and keeps that shape.
+	template<class SearchGrid>
+	static void SmoothPath(SearchGrid& aSearchGrid, const GridLocation& aStartLocation, std::vector<GridLocation>& outPath);
+
+	template<class SearchGrid>
+	static bool IsWalkable(SearchGrid& aSearchGrid, const int aX, const int aY)
+	{
+		if (aX < 0 || aY < 0 || aX >= aSearchGrid.GetWidth() || aY >= aSearchGrid.GetHeight())
+		{
+			return false;
+		}
+
+		return aSearchGrid.GetCell(GridLocation(aX, aY)).walkable;
+	}
+};
+
+template<class SearchGrid>
+inline bool PathSmoothing::HasLineOfSight(SearchGrid& aSearchGrid, const GridLocation& aFrom, const GridLocation& aTo)
+{
+	int x = aFrom.x;
+	int y = aFrom.y;
+
+	const int stepX = aTo.x > x ? 1 : -1;
+	const int stepY = aTo.y > y ? 1 : -1;
+	const int distanceX = std::abs(aTo.x - x) * 2;
+	const int distanceY = std::abs(aTo.y - y) * 2;
+
+	if (!IsWalkable(aSearchGrid, x, y))
+	{
+		return false;
+	}
+
+	// Positive when the line leaves the current cell through its side in x first, negative for y and zero through the corner
+	int error = (distanceX - distanceY) / 2;
+
+	for (int steps = (distanceX + distanceY) / 2; steps > 0; --steps)
+	{
+		if (error > 0)
+		{
+			x += stepX;
+			error -= distanceY;
+		}
+		else if (error < 0)
+		{
+			y += stepY;
+			error += distanceX;
+		}
+		else
+		{
+			if (!IsWalkable(aSearchGrid, x + stepX, y) || !IsWalkable(aSearchGrid, x, y + stepY))
+			{
+				return false;
+			}
+
+			x += stepX;
+			y += stepY;
+			error += distanceX - distanceY;
+			--steps;
+		}
+
+		if (!IsWalkable(aSearchGrid, x, y))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+template<class SearchGrid>
+inline void PathSmoothing::SmoothPath(SearchGrid& aSearchGrid, const GridLocation& aStartLocation, std::vector<GridLocation>& outPath)
+{
+	if (outPath.size() < 2)
+	{
+		return;
+	}
+
+	// Walked from the start, so the kept waypoints are written over the front of the reversed copy
+	std::vector<GridLocation> path(outPath.rbegin(), outPath.rend());
+
+	size_t waypointCount = 0;
+	GridLocation anchor = aStartLocation;
+
+	for (size_t i = 1; i < path.size(); ++i)
+	{
+		if (!HasLineOfSight(aSearchGrid, anchor, path[i]))
+		{
+			anchor = path[i - 1];
+			path[waypointCount++] = anchor;
+		}
+	}
+
+	path[waypointCount++] = path.back();
+	path.resize(waypointCount);
+
+	outPath.assign(path.rbegin(), path.rend());
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "Vector2.h"
+
+namespace CommonUtilities
+{
+
+	template <class T>
+	class AABB2D
+	{
+		public:
+			// Default constructor: there is no AABB, both min and max points are the zero vector.
+			AABB2D();
+
+			// Copy constructor.
+			AABB2D(const AABB2D<T>& aAABB2D);
+
+			// Constructor taking the positions of the minimum and maximum corners.
+			AABB2D(const Vector2<T>& aMin, const Vector2<T>& aMax);
+
+			// Init the AABB with the positions of the minimum and maximum corners, same as the constructor above.
+			void InitWithMinAndMax(const Vector2<T>& aMin, const Vector2<T>& aMax);
+
+			// Returns whether a point is inside the AABB: it is inside when the point is on any of the AABB's sides or inside of the AABB.
+			bool IsInside(const Vector2<T>& aPosition) const;
+
+			// Returns whether the square with center aCenter and half width aHalfWidth touches the AABB.
+			bool Overlaps(const Vector2<T>& aCenter, const T aHalfWidth) const;
+
+			// Tests aCount squares given as separate arrays of centers and half widths, outOverlaps[i] is the result for square i.
+			// Written without branches so the loop can be vectorized.
+			void Overlaps(const T* someX, const T* someY, const T* someHalfWidths, const int aCount, bool* outOverlaps) const;
+
+			// Returns whether the square with center aCenter and half width aHalfWidth is completely inside the AABB.
+			bool Contains(const Vector2<T>& aCenter, const T aHalfWidth) const;
+
+			const Vector2<T>& GetMin() const;
+			const Vector2<T>& GetMax() const;
+
+		private:
+			Vector2<T> myMin;
+			Vector2<T> myMax;
+
+	};
+
+	template<class T>
+	inline AABB2D<T>::AABB2D():
+		myMin(),
+		myMax()
+	{}
+
+	template<class T>
+	inline AABB2D<T>::AABB2D(const AABB2D<T>& aAABB2D):
+		myMin(aAABB2D.myMin),
+		myMax(aAABB2D.myMax)
+	{}
+
+	template<class T>
+	inline AABB2D<T>::AABB2D(const Vector2<T>& aMin, const Vector2<T>& aMax):
+		myMin(aMin),
+		myMax(aMax)
+	{}
+
+	template<class T>
+	inline void AABB2D<T>::InitWithMinAndMax(const Vector2<T>& aMin, const Vector2<T>& aMax)
+	{
+		myMin = aMin;
+		myMax = aMax;
+	}
+
+	template<class T>
+	inline bool AABB2D<T>::IsInside(const Vector2<T>& aPosition) const
+	{
+		return aPosition.x >= myMin.x && aPosition.y >= myMin.y && aPosition.x <= myMax.x && aPosition.y <= myMax.y;
+	}
+
+	template<class T>
+	inline bool AABB2D<T>::Overlaps(const Vector2<T>& aCenter, const T aHalfWidth) const
+	{
+		return aCenter.x + aHalfWidth >= myMin.x && aCenter.x - aHalfWidth <= myMax.x &&
+			   aCenter.y + aHalfWidth >= myMin.y && aCenter.y - aHalfWidth <= myMax.y;
+	}
+
+	template<class T>
+	inline void AABB2D<T>::Overlaps(const T* someX, const T* someY, const T* someHalfWidths, const int aCount, bool* outOverlaps) const
+	{
+		for (int i = 0; i < aCount; ++i)
+		{
+			outOverlaps[i] = (someX[i] + someHalfWidths[i] >= myMin.x) & (someX[i] - someHalfWidths[i] <= myMax.x) &
+							 (someY[i] + someHalfWidths[i] >= myMin.y) & (someY[i] - someHalfWidths[i] <= myMax.y);
+		}
+	}
+
+	template<class T>
+	inline bool AABB2D<T>::Contains(const Vector2<T>& aCenter, const T aHalfWidth) const
+	{
+		return aCenter.x - aHalfWidth >= myMin.x && aCenter.x + aHalfWidth <= myMax.x &&
+			   aCenter.y - aHalfWidth >= myMin.y && aCenter.y + aHalfWidth <= myMax.y;
+	}
+
+	template<class T>
+	inline const Vector2<T>& AABB2D<T>::GetMin() const
+	{
+		return myMin;
+	}
+
+	template<class T>
+	inline const Vector2<T>& AABB2D<T>::GetMax() const
+	{
+		return myMax;
+	}
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "Vector2.h"
+
+#include <cmath>
+
+namespace CommonUtilities
+{
+
+	template <class T>
+	class Circle
+	{
+
+		public:
+			// Default constructor: there is no circle, the radius is zero and the position is the zero vector.
+			Circle();
+
+			// Copy constructor.
+			Circle(const Circle<T>& aCircle);
+
+			// Constructor that takes the center position and radius of the circle.
+			Circle(const Vector2<T>& aCenter, const T aRadius);
+
+			// Init the circle with a center and a radius, the same as the constructor above.
+			void InitWithCenterAndRadius(const Vector2<T>& aCenter, const T aRadius);
+
+			// Returns whether a point is inside the circle: it is inside when the point is on the
+			// circle edge or inside of the circle.
+			bool IsInside(const Vector2<T>& aPosition) const;
+
+			// Returns whether the square with center aCenter and half width aHalfWidth touches the circle.
+			bool Overlaps(const Vector2<T>& aCenter, const T aHalfWidth) const;
+
+			// Tests aCount squares given as separate arrays of centers and half widths, outOverlaps[i] is the result for square i.
+			// Written without branches so the loop can be vectorized.
+			void Overlaps(const T* someX, const T* someY, const T* someHalfWidths, const int aCount, bool* outOverlaps) const;
+
+			// Returns whether the square with center aCenter and half width aHalfWidth is completely inside the circle.
+			bool Contains(const Vector2<T>& aCenter, const T aHalfWidth) const;
+
+			const Vector2<T>& GetCenter() const;
+			const T GetRadius() const;
+
+		private:
+			Vector2<T> myCenter;
+			T myRadius;
+
+	};
+
+	template<class T>
+	inline Circle<T>::Circle():
+		myCenter(),
+		myRadius()
+	{}
+
+	template<class T>
+	inline Circle<T>::Circle(const Circle<T>& aCircle):
+		myCenter(aCircle.myCenter),
+		myRadius(aCircle.myRadius)
+	{}
+
+	template<class T>
+	inline Circle<T>::Circle(const Vector2<T>& aCenter, const T aRadius):
+		myCenter(aCenter),
+		myRadius(aRadius)
+	{}
+
+	template<class T>
+	inline void Circle<T>::InitWithCenterAndRadius(const Vector2<T>& aCenter, const T aRadius)
+	{
+		myCenter = aCenter;
+		myRadius = aRadius;
+	}
+
+	template<class T>
+	inline bool Circle<T>::IsInside(const Vector2<T>& aPosition) const
+	{
+		const Vector2<T> distance = aPosition - myCenter;
+		return distance.LengthSqr() <= myRadius * myRadius;
+	}
+
+	template<class T>
+	inline bool Circle<T>::Overlaps(const Vector2<T>& aCenter, const T aHalfWidth) const
+	{
+		// Distance from the circle center to the closest point of the square
+		T dx = std::abs(myCenter.x - aCenter.x) - aHalfWidth;
+		T dy = std::abs(myCenter.y - aCenter.y) - aHalfWidth;
+
+		dx = dx > T() ? dx : T();
+		dy = dy > T() ? dy : T();
+
+		return dx * dx + dy * dy <= myRadius * myRadius;
+	}
+
+	template<class T>
+	inline void Circle<T>::Overlaps(const T* someX, const T* someY, const T* someHalfWidths, const int aCount, bool* outOverlaps) const
+	{
+		const T sqrRadius = myRadius * myRadius;
+
+		for (int i = 0; i < aCount; ++i)
+		{
+			T dx = std::abs(myCenter.x - someX[i]) - someHalfWidths[i];
+			T dy = std::abs(myCenter.y - someY[i]) - someHalfWidths[i];
+
+			dx = dx > T() ? dx : T();
+			dy = dy > T() ? dy : T();
+
+			outOverlaps[i] = dx * dx + dy * dy <= sqrRadius;
+		}
+	}
+
+	template<class T>
+	inline bool Circle<T>::Contains(const Vector2<T>& aCenter, const T aHalfWidth) const
+	{
+		// Distance from the circle center to the farthest corner of the square
+		T dx = std::abs(myCenter.x - aCenter.x) + aHalfWidth;
+		T dy = std::abs(myCenter.y - aCenter.y) + aHalfWidth;
+
+		return dx * dx + dy * dy <= myRadius * myRadius;
+	}
+
+	template<class T>
+	inline const Vector2<T>& Circle<T>::GetCenter() const
+	{
+		return myCenter;
+	}
+
+	template<class T>
+	inline const T Circle<T>::GetRadius() const
+	{
+		return myRadius;
+	}
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "Line.h"
+
+#include <cmath>
+#include <vector>
+
+namespace CommonUtilities
+{
+
+	/*
+		Convex area built from lines, a position is inside when it is inside every line.
+		Used for 2D view culling where the lines are the edges of the camera's view.
+	*/
+	template <class T>
+	class Frustum2D
+	{
+
+		public:
+			// Default constructor: empty frustum, every position is inside.
+			Frustum2D() = default;
+
+			// Constructor taking the lines that bound the frustum, the normals should point out of the frustum.
+			Frustum2D(const std::vector<Line<T>>& aLineList);
+
+			void AddLine(const Line<T>& aLine);
+
+			// Returns whether a point is inside the frustum: it is inside when it is inside all lines.
+			bool IsInside(const Vector2<T>& aPosition) const;
+
+			// Returns whether the square with center aCenter and half width aHalfWidth touches the frustum.
+			// Conservative, squares close to a corner of the frustum can be reported as touching.
+			bool Overlaps(const Vector2<T>& aCenter, const T aHalfWidth) const;
+
+			// Tests aCount squares given as separate arrays of centers and half widths, outOverlaps[i] is the result for square i.
+			// Written without branches so the loop can be vectorized.
+			void Overlaps(const T* someX, const T* someY, const T* someHalfWidths, const int aCount, bool* outOverlaps) const;
+
+			// Returns whether the square with center aCenter and half width aHalfWidth is completely inside the frustum.
+			bool Contains(const Vector2<T>& aCenter, const T aHalfWidth) const;
+
+			const std::vector<Line<T>>& GetLines() const;
+
+		private:
+			// Signed distance from the line to the square center and the square's extent along the line normal
+			static void Project(const Line<T>& aLine, const Vector2<T>& aCenter, const T aHalfWidth, T& outDistance, T& outExtent);
+
+		private:
+			std::vector<Line<T>> myLines;
+
+	};
+
+	template<class T>
+	inline Frustum2D<T>::Frustum2D(const std::vector<Line<T>>& aLineList):
+		myLines(aLineList)
+	{}
+
+	template<class T>
+	inline void Frustum2D<T>::AddLine(const Line<T>& aLine)
+	{
+		myLines.push_back(aLine);
+	}
+
+	template<class T>
+	inline bool Frustum2D<T>::IsInside(const Vector2<T>& aPosition) const
+	{
+		for (const Line<T>& line : myLines)
+		{
+			if (!line.IsInside(aPosition))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	template<class T>
+	inline bool Frustum2D<T>::Overlaps(const Vector2<T>& aCenter, const T aHalfWidth) const
+	{
+		for (const Line<T>& line : myLines)
+		{
+			T distance, extent;
+			Project(line, aCenter, aHalfWidth, distance, extent);
+
+			if (distance > extent)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	template<class T>
+	inline void Frustum2D<T>::Overlaps(const T* someX, const T* someY, const T* someHalfWidths, const int aCount, bool* outOverlaps) const
+	{
+		for (int i = 0; i < aCount; ++i)
+		{
+			outOverlaps[i] = true;
+		}
+
+		for (const Line<T>& line : myLines)
+		{
+			const Vector2<T>& normal = line.GetNormal();
+			const Vector2<T>& point = line.GetPoint();
+			const T extentScale = std::abs(normal.x) + std::abs(normal.y);
+
+			for (int i = 0; i < aCount; ++i)
+			{
+				const T distance = normal.x * (someX[i] - point.x) + normal.y * (someY[i] - point.y);
+				outOverlaps[i] &= distance <= someHalfWidths[i] * extentScale;
+			}
+		}
+	}
+
+	template<class T>
+	inline bool Frustum2D<T>::Contains(const Vector2<T>& aCenter, const T aHalfWidth) const
+	{
+		for (const Line<T>& line : myLines)
+		{
+			T distance, extent;
+			Project(line, aCenter, aHalfWidth, distance, extent);
+
+			if (distance > -extent)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	template<class T>
+	inline const std::vector<Line<T>>& Frustum2D<T>::GetLines() const
+	{
+		return myLines;
+	}
+
+	template<class T>
+	inline void Frustum2D<T>::Project(const Line<T>& aLine, const Vector2<T>& aCenter, const T aHalfWidth, T& outDistance, T& outExtent)
+	{
+		const Vector2<T>& normal = aLine.GetNormal();
+
+		outDistance = normal.Dot(aCenter - aLine.GetPoint());
+		outExtent = aHalfWidth * (std::abs(normal.x) + std::abs(normal.y));
+	}
+}
@@ -33,6 +33,9 @@ namespace CommonUtilities
 			// Returns the normal of the line, which is (-direction.y, direction.x).
 			const Vector2<T>& GetNormal() const;
 
+			// Return a point on the line.
+			const Vector2<T>& GetPoint() const;
+
 		private:
 			Vector2<T> myPoint;
 			Vector2<T> myDirection;
@@ -97,4 +100,10 @@ namespace CommonUtilities
 	{
 		return myNormal;
 	}
+
+	template<class T>
+	inline const Vector2<T>& Line<T>::GetPoint() const
+	{
+		return myPoint;
+	}
 }
\ No newline at end of file
@@ -1,84 +1,1320 @@
 #pragma once
 
 #include "QuadTreeObject.h"
+#include "../../Pool/Thread/ThreadPool.h"
 
 #include <Math/Vector2.h>
+#include <Collision/AABB2D.h>
+#include <Collision/Circle.h>
+#include <Collision/Frustum2D.h>
 
+#include <latch>
+#include <cmath>
+#include <cfloat>
 #include <vector>
+#include <utility>
+#include <cstdint>
+#include <algorithm>
+#include <assert.h>
 
-class DebugDrawer;
+using AABB2Df = CommonUtilities::AABB2D<float>;
+using Circlef = CommonUtilities::Circle<float>;
+using Frustum2Df = CommonUtilities::Frustum2D<float>;
+
+template <int Capacity, int MaxDepth>
 class LooseQuadTree;
 
+// Stable reference to an inserted object, valid until the object is removed
+using QuadTreeHandle = int;
+
+// Ids of two objects whose bounds overlap
+using LooseQuadTreePair = std::pair<uint32_t, uint32_t>;
+
+template <int Capacity>
 class LooseQuadTreeNode
 {
+	template <int, int>
 	friend class LooseQuadTree;
 
 	public:
 		LooseQuadTreeNode() = default;
-		~LooseQuadTreeNode();
 
-		inline const std::vector<LooseQuadTreeNode*>& GetChildren() const { return myChildren; }
-		inline std::vector<QuadTreeObject*> GetObjects() { return myObjects; }
+		// Index of the first of the four adjacent children, children are stored in the order top left, top right, bottom right, bottom left
+		inline int GetFirstChild() const { return myFirstChild; }
+		inline int GetParent() const { return myParent; }
+		inline int GetDepth() const { return myDepth; }
+		inline int GetObjectCount() const { return myObjectCount; }
+		inline bool IsLeaf() const { return myFirstChild == -1; }
 
 		inline const Vector2f& GetPosition() const { return myPosition; }
 		inline float GetSize() const { return GetHalfSize() * 2.f; }
 		inline float GetLooseness() const { return myLoosenessfactor; }
 
-		bool contains(Vector2f aPosition);
+		bool contains(Vector2f aPosition) const;
 
 	private:
 		const float GetHalfSize() const { return myHalfWidth * myLoosenessfactor; }
-		
-		bool Insert(QuadTreeObject& aObject);
-		bool Inside(QuadTreeObject& aObject);
 
-		LooseQuadTreeNode* FindClosestChild(LooseQuadTreeNode* aNode, QuadTreeObject& aObject);
+		bool Inside(const QuadTreeObject& aObject) const;
 
-		void CreateChildren();
+		QuadTreeObject GetBucketObject(const int aIndex) const;
+		void SetBucketObject(const int aIndex, const QuadTreeObject& aObject, const QuadTreeHandle aHandle);
 
 	private:
 		Vector2f myPosition;
-		float myHalfWidth;
-		float myLoosenessfactor;
+		float myHalfWidth = 0.f;
+		float myLoosenessfactor = 1.f;
+
+		int myParent = -1;
+		int myFirstChild = -1;
+		int myDepth = 0;
+		int myObjectCount = 0;
 
-		bool myDivided;
-		static const int myCapacity = 4;
+		// The first Capacity objects live in the node, the rest in an overflow list in the element pool
+		int myFirstOverflow = -1;
 
-		std::vector<LooseQuadTreeNode*> myChildren;
-		std::vector<QuadTreeObject*> myObjects;
+		// Bucket stored as one array per field so the leaf tests can check several objects at a time
+		float myX[Capacity] = {};
+		float myY[Capacity] = {};
+		float myHalfWidths[Capacity] = {};
+		uint32_t myIds[Capacity] = {};
+		QuadTreeHandle myHandles[Capacity] = {};
+};
+
+// Object that did not fit in the bucket of its node, linked to the next overflow object of the same node
+struct LooseQuadTreeElement
+{
+	QuadTreeObject object;
+	QuadTreeHandle handle;
+	int next;
+};
+
+// The node a handle is stored in, node is -1 for free slots which use nextFree to link the free list
+struct LooseQuadTreeSlot
+{
+	int node;
+	int nextFree;
 };
 
 
+/*
+	Same storage as QuadTree: nodes in one array with four adjacent children and up to Capacity
+	objects stored inline in each node with the rest in an overflow list.
+	The world is covered by a grid of square roots with the side of its shorter edge, so a long level
+	gets one row of roots instead of a square root that is mostly empty. The roots are the first nodes.
+	Only the bounds and id of each object are stored, the rest of the object's data stays with the user.
+	Node pointers handed out by GetIntersected are only valid until the tree is modified.
+*/
+template <int Capacity = 8, int MaxDepth = 16>
 class LooseQuadTree
 {
+	static_assert(Capacity > 0, "A node needs room for at least one object");
+	static_assert(MaxDepth > 0, "LooseQuadTree needs at least one level below the root");
 
 	public:
+		using Node = LooseQuadTreeNode<Capacity>;
+
 		LooseQuadTree() = default;
 		~LooseQuadTree() = default;
 
+		// The looseness can not be below one, Query and the pair walk skip a subtree when the parent's loose bounds miss
 		void Init(const float aWidth, const float aHeight, const float aLossenessfactor = 1.f);
 
-		void Render(DebugDrawer& aDebugDrawer)
-		{
-			Render(aDebugDrawer, myRoot);
-		}
+		// Every level uses a looseness of two, which holds any object no wider than the node whose center is in the node.
+		// The insertion depth is then computed from the half width of the object instead of testing the children on the way down.
+		void InitWithAdaptiveLooseness(const float aWidth, const float aHeight);
 
-		void Insert(QuadTreeObject& aObject)
-		{
-			myRoot.Insert(aObject);
-		}
+		// Removes all nodes and objects but keeps the allocated memory for the next build
+		void Clear();
+
+		template <class Drawer>
+		void Render(Drawer& aDebugDrawer) const;
+
+		// Stores a copy of the object's bounds and id, returns -1 if the object's center is outside the world.
+		// Objects crossing the edge of their root are kept in the root.
+		QuadTreeHandle Insert(const QuadTreeObject& aObject);
+
+		// Removes the object and collapses nodes whose children hold no more than the capacity
+		void Remove(const QuadTreeHandle aHandle);
+
+		// Moves the object, it is only moved to another node when it leaves the loose bounds of its current node.
+		// Unlike Insert it can not fail, an object moved outside the world stays in the closest root.
+		void Update(const QuadTreeHandle aHandle, const Vector2f& aNewPosition);
+
+		QuadTreeObject GetObject(const QuadTreeHandle aHandle) const;
+
+		void GetIntersected(Vector2f aPosition, std::vector<Node*>& outIntersected);
 
-		void GetIntersected(Vector2f aPosition, std::vector<LooseQuadTreeNode*>& outIntersected);
+		void GetObjects(const Node& aNode, std::vector<uint32_t>& outIds) const;
+
+		// Appends the id of every object touching the query area to outIds, the buffer is not cleared
+		void QueryRect(const AABB2Df& aRect, std::vector<uint32_t>& outIds) const { Query(aRect, outIds); }
+		void QueryCircle(const Circlef& aCircle, std::vector<uint32_t>& outIds) const { Query(aCircle, outIds); }
+		void QueryFrustum2D(const Frustum2Df& aFrustum, std::vector<uint32_t>& outIds) const { Query(aFrustum, outIds); }
+
+		// Appends the ids of the aCount objects closest to aPosition and no further away than aMaxRadius to outIds, closest first.
+		// Nodes are visited in order of distance so the search ends as soon as no unvisited node can hold a closer object.
+		void FindNearest(const Vector2f& aPosition, const int aCount, const float aMaxRadius, std::vector<uint32_t>& outIds) const;
+
+		// Same as above but only objects accepted by aFilter, a bool(uint32_t aId) predicate, are returned
+		template <class Filter>
+		void FindNearest(const Vector2f& aPosition, const int aCount, const float aMaxRadius, std::vector<uint32_t>& outIds, Filter&& aFilter) const;
+
+		// Broad phase, outPairs is overwritten with every pair of objects whose square bounds overlap, each pair once.
+		// Every node is only tested against the nodes whose loose bounds overlap its own.
+		void CollectPotentialPairs(std::vector<LooseQuadTreePair>& outPairs) const;
+
+		// Same result as above, the nodes are split into batches that are tested on the pool.
+		// Runs on the calling thread when the pool has no threads or is terminated, must not be called from a worker of the pool.
+		void CollectPotentialPairs(std::vector<LooseQuadTreePair>& outPairs, ThreadPool& aThreadPool) const;
+
+		inline const std::vector<Node>& GetNodes() const { return myNodes; }
+		inline const Node& GetRoot(const int aIndex = 0) const { return myNodes[aIndex]; }
+		inline int GetRootCount() const { return myRootColumns * myRootRows; }
 
 	private:
+		// A depth first walk keeps at most three unvisited siblings per level on the stack
+		static constexpr int ourTraversalStackSize = 3 * MaxDepth + 4;
+
+		// Nodes per task in the parallel CollectPotentialPairs
+		static constexpr size_t ourPairBatchSize = 64;
+
+		// Calls aFunction with 0 to Count - 1, unrolled at compile time
+		template <int Count, class Function>
+		static void Unroll(Function&& aFunction);
+
+		// Calls aFunction with every object and its handle in aNode, the bucket part is unrolled
+		template <class Function>
+		void ForEachObject(const Node& aNode, Function&& aFunction) const;
+
+		template <class Shape>
+		void Query(const Shape& aShape, std::vector<uint32_t>& outIds) const;
+
+		int AllocateElement(const QuadTreeObject& aObject, const QuadTreeHandle aHandle);
+		void FreeElement(const int aElement);
+
+		QuadTreeHandle AllocateSlot();
+		void FreeSlot(const QuadTreeHandle aHandle);
+
+		int AllocateChildren();
+		void FreeChildren(const int aFirstChild);
+
+		void LinkObject(const int aNodeIndex, const QuadTreeObject& aObject, const QuadTreeHandle aHandle);
+
+		// Removes the handle from the node and returns the object that was stored for it
+		QuadTreeObject UnlinkObject(const int aNodeIndex, const QuadTreeHandle aHandle);
+
+		// The root whose tight bounds hold aPosition, positions outside the world get the closest root
+		int FindRoot(const Vector2f& aPosition) const;
+
+		// Child of aNode that should hold the object, -1 if it stays in aNode
+		int FindChild(const Node& aNode, const QuadTreeObject& aObject) const;
+		int FindClosestChild(const Node& aNode, const QuadTreeObject& aObject) const;
+		int FindQuadrantChild(const Node& aNode, const Vector2f& aPosition) const;
+		int FindInsertNode(const int aStartNode, const QuadTreeObject& aObject) const;
+
+		// Deepest level whose nodes are at least as wide as the object, used with adaptive looseness
+		int GetTargetDepth(const float aHalfWidth) const;
+
+		bool ShouldSplit(const Node& aNode) const;
+
+		// Appends the index of every node in the tree, freed children are skipped
+		void GetTreeNodes(std::vector<int>& outNodes) const;
+
+		// Pairs between the objects of aNodeIndex and the objects of itself and every overlapping node with a higher index
+		void CollectPairs(const int aNodeIndex, std::vector<LooseQuadTreePair>& outPairs) const;
 
-		void Render(DebugDrawer& aDebugDrawer, LooseQuadTreeNode& aNode);
+		static bool Overlaps(const Vector2f& aFirstCenter, const float aFirstHalfWidth, const Vector2f& aSecondCenter, const float aSecondHalfWidth);
 
-		void SearchIntersected(LooseQuadTreeNode* aNode, Vector2f& aPosition, std::vector<LooseQuadTreeNode*>& outIntersected);
+		void CreateChildren(const int aNodeIndex);
+
+		void TryCollapse(const int aNodeIndex);
+		bool Collapse(const int aNodeIndex);
 
 	private:
 		float myWidth;
 		float myHeight;
+		float myLoosenessfactor;
+		float myRootSize;
+
+		int myRootColumns;
+		int myRootRows;
+
+		bool myAdaptiveLooseness = false;
+
+		std::vector<Node> myNodes;
+		std::vector<LooseQuadTreeElement> myElements;
+		std::vector<LooseQuadTreeSlot> mySlots;
+
+		int myFreeElement = -1;
+		int myFreeSlot = -1;
+		int myFreeChildren = -1;
+};
+
+template<int Capacity>
+inline bool LooseQuadTreeNode<Capacity>::contains(Vector2f aPosition) const
+{
+	Vector2f min = { myPosition.x - myHalfWidth, myPosition.y - myHalfWidth };
+	Vector2f max = { myPosition.x + myHalfWidth, myPosition.y + myHalfWidth };
+
+	return aPosition.x >= min.x && aPosition.y >= min.y && aPosition.x <= max.x && aPosition.y <= max.y;
+}
+
+template<int Capacity>
+inline bool LooseQuadTreeNode<Capacity>::Inside(const QuadTreeObject& aObject) const
+{
+	bool insideX = std::abs(aObject.position.x - myPosition.x) < (GetHalfSize() - aObject.halfWidth);
+	bool insideY = std::abs(aObject.position.y - myPosition.y) < (GetHalfSize() - aObject.halfWidth);
+
+	return insideX && insideY;
+}
+
+template<int Capacity>
+inline QuadTreeObject LooseQuadTreeNode<Capacity>::GetBucketObject(const int aIndex) const
+{
+	return { { myX[aIndex], myY[aIndex] }, myHalfWidths[aIndex], myIds[aIndex] };
+}
+
+template<int Capacity>
+inline void LooseQuadTreeNode<Capacity>::SetBucketObject(const int aIndex, const QuadTreeObject& aObject, const QuadTreeHandle aHandle)
+{
+	myX[aIndex] = aObject.position.x;
+	myY[aIndex] = aObject.position.y;
+	myHalfWidths[aIndex] = aObject.halfWidth;
+	myIds[aIndex] = aObject.id;
+	myHandles[aIndex] = aHandle;
+}
+
+template<int Capacity, int MaxDepth>
+inline void LooseQuadTree<Capacity, MaxDepth>::Init(const float aWidth, const float aHeight, const float aLossenessfactor)
+{
+	assert(aLossenessfactor >= 1.f && "A child's loose bounds have to be inside its parent's");
+
+	myWidth = aWidth;
+	myHeight = aHeight;
+	myLoosenessfactor = aLossenessfactor;
+	myAdaptiveLooseness = false;
+
+	myRootSize = std::min(aWidth, aHeight);
+	myRootColumns = std::max(1, static_cast<int>(std::ceil(aWidth / myRootSize)));
+	myRootRows = std::max(1, static_cast<int>(std::ceil(aHeight / myRootSize)));
+
+	Clear();
+}
+
+template<int Capacity, int MaxDepth>
+inline void LooseQuadTree<Capacity, MaxDepth>::InitWithAdaptiveLooseness(const float aWidth, const float aHeight)
+{
+	Init(aWidth, aHeight, 2.f);
+	myAdaptiveLooseness = true;
+}
+
+template<int Capacity, int MaxDepth>
+inline void LooseQuadTree<Capacity, MaxDepth>::Clear()
+{
+	myNodes.clear();
+	myElements.clear();
+	mySlots.clear();
+
+	myFreeElement = -1;
+	myFreeSlot = -1;
+	myFreeChildren = -1;
+
+	for (int row = 0; row < myRootRows; ++row)
+	{
+		for (int column = 0; column < myRootColumns; ++column)
+		{
+			Node root;
+			root.myHalfWidth = myRootSize * 0.5f;
+			root.myPosition.x = myRootSize * column + root.myHalfWidth;
+			root.myPosition.y = myRootSize * row + root.myHalfWidth;
+			root.myLoosenessfactor = myLoosenessfactor;
+
+			myNodes.push_back(root);
+		}
+	}
+}
+
+template<int Capacity, int MaxDepth>
+inline QuadTreeHandle LooseQuadTree<Capacity, MaxDepth>::Insert(const QuadTreeObject& aObject)
+{
+	// The roots can reach past the world when it is not a whole number of roots wide
+	if (aObject.position.x < 0.f || aObject.position.y < 0.f || aObject.position.x > myWidth || aObject.position.y > myHeight)
+	{
+		return -1;
+	}
+
+	const int root = FindRoot(aObject.position);
+
+	QuadTreeHandle handle = AllocateSlot();
+	int nodeIndex = FindInsertNode(root, aObject);
+
+	LinkObject(nodeIndex, aObject, handle);
+	mySlots[handle].node = nodeIndex;
+
+	if (ShouldSplit(myNodes[nodeIndex]))
+	{
+		CreateChildren(nodeIndex);
+	}
+
+	return handle;
+}
+
+template<int Capacity, int MaxDepth>
+inline void LooseQuadTree<Capacity, MaxDepth>::Remove(const QuadTreeHandle aHandle)
+{
+	const int nodeIndex = mySlots[aHandle].node;
+	assert(nodeIndex != -1 && "Removing a handle that is not in the tree");
+
+	UnlinkObject(nodeIndex, aHandle);
+	FreeSlot(aHandle);
+
+	TryCollapse(nodeIndex);
+}
+
+template<int Capacity, int MaxDepth>
+inline void LooseQuadTree<Capacity, MaxDepth>::Update(const QuadTreeHandle aHandle, const Vector2f& aNewPosition)
+{
+	const int oldNode = mySlots[aHandle].node;
+	assert(oldNode != -1 && "Updating a handle that is not in the tree");
+
+	QuadTreeObject object = UnlinkObject(oldNode, aHandle);
+	object.position = aNewPosition;
+
+	if (myNodes[oldNode].Inside(object))
+	{
+		LinkObject(oldNode, object, aHandle);
+		return;
+	}
+
+	// Walk up to the first node whose tight bounds hold the center and whose loose bounds hold the object,
+	// descending from there picks the same node as an insert. Objects leaving the world are kept in the closest root.
+	int ancestor = myNodes[oldNode].myParent;
+	while (ancestor != -1 && !(myNodes[ancestor].contains(object.position) && myNodes[ancestor].Inside(object)))
+	{
+		ancestor = myNodes[ancestor].myParent;
+	}
+
+	int nodeIndex = FindInsertNode(ancestor != -1 ? ancestor : FindRoot(object.position), object);
+
+	LinkObject(nodeIndex, object, aHandle);
+	mySlots[aHandle].node = nodeIndex;
+
+	if (ShouldSplit(myNodes[nodeIndex]))
+	{
+		CreateChildren(nodeIndex);
+	}
+
+	TryCollapse(oldNode);
+}
+
+template<int Capacity, int MaxDepth>
+inline QuadTreeObject LooseQuadTree<Capacity, MaxDepth>::GetObject(const QuadTreeHandle aHandle) const
+{
+	assert(mySlots[aHandle].node != -1 && "Getting a handle that is not in the tree");
+
+	QuadTreeObject result = {};
+	ForEachObject(myNodes[mySlots[aHandle].node], [&](const QuadTreeObject& aObject, const QuadTreeHandle aObjectHandle)
+	{
+		if (aObjectHandle == aHandle)
+		{
+			result = aObject;
+		}
+	});
+
+	return result;
+}
+
+template<int Capacity, int MaxDepth>
+template<class Drawer>
+inline void LooseQuadTree<Capacity, MaxDepth>::Render(Drawer& aDebugDrawer) const
+{
+	// Walk from the roots since freed children are still in the node array, draws the tight bounds
+	std::vector<int> stack;
+	for (int root = 0; root < GetRootCount(); ++root)
+	{
+		stack.push_back(root);
+	}
+
+	while (!stack.empty())
+	{
+		const Node& node = myNodes[stack.back()];
+		stack.pop_back();
+
+		float minX = node.myPosition.x - node.myHalfWidth;
+		float minY = node.myPosition.y - node.myHalfWidth;
+
+		float maxX = node.myPosition.x + node.myHalfWidth;
+		float maxY = node.myPosition.y + node.myHalfWidth;
+
+		aDebugDrawer.DrawLine({ minX, maxY }, { maxX, maxY });
+		aDebugDrawer.DrawLine({ maxX, maxY }, { maxX, minY });
+		aDebugDrawer.DrawLine({ maxX, minY }, { minX, minY });
+		aDebugDrawer.DrawLine({ minX, minY }, { minX, maxY });
+
+		if (!node.IsLeaf())
+		{
+			for (int i = 0; i < 4; ++i)
+			{
+				stack.push_back(node.myFirstChild + i);
+			}
+		}
+	}
+}
+
+template<int Capacity, int MaxDepth>
+inline void LooseQuadTree<Capacity, MaxDepth>::GetIntersected(Vector2f aPosition, std::vector<Node*>& outIntersected)
+{
+	int nodeIndex = FindRoot(aPosition);
+	if (!myNodes[nodeIndex].contains(aPosition))
+	{
+		return;
+	}
+
+	outIntersected.push_back(&myNodes[nodeIndex]);
+
+	while (!myNodes[nodeIndex].IsLeaf())
+	{
+		int firstChild = myNodes[nodeIndex].myFirstChild;
+		nodeIndex = -1;
+
+		for (int i = 0; i < 4; ++i)
+		{
+			if (myNodes[firstChild + i].contains(aPosition))
+			{
+				nodeIndex = firstChild + i;
+				break;
+			}
+		}
+
+		if (nodeIndex == -1)
+		{
+			return;
+		}
+
+		outIntersected.push_back(&myNodes[nodeIndex]);
+	}
+}
+
+template<int Capacity, int MaxDepth>
+inline void LooseQuadTree<Capacity, MaxDepth>::GetObjects(const Node& aNode, std::vector<uint32_t>& outIds) const
+{
+	ForEachObject(aNode, [&](const QuadTreeObject& aObject, const QuadTreeHandle)
+	{
+		outIds.push_back(aObject.id);
+	});
+}
+
+template<int Capacity, int MaxDepth>
+inline void LooseQuadTree<Capacity, MaxDepth>::FindNearest(const Vector2f& aPosition, const int aCount, const float aMaxRadius, std::vector<uint32_t>& outIds) const
+{
+	FindNearest(aPosition, aCount, aMaxRadius, outIds, [](const uint32_t) { return true; });
+}
+
+/*
+	Best first search. Nodes are kept in a min heap on the squared distance to their loose bounds,
+	which is a lower bound for every object center stored below them, and the best objects so far in a max heap.
+*/
+template<int Capacity, int MaxDepth>
+template<class Filter>
+inline void LooseQuadTree<Capacity, MaxDepth>::FindNearest(const Vector2f& aPosition, const int aCount, const float aMaxRadius, std::vector<uint32_t>& outIds, Filter&& aFilter) const
+{
+	struct NodeCandidate
+	{
+		float sqrDistance;
+		int node;
+	};
+
+	struct ObjectCandidate
+	{
+		float sqrDistance;
+		uint32_t id;
+	};
+
+	if (aCount <= 0)
+	{
+		return;
+	}
+
+	auto closer = [](const auto& aLeft, const auto& aRight) { return aLeft.sqrDistance < aRight.sqrDistance; };
+	auto further = [](const auto& aLeft, const auto& aRight) { return aLeft.sqrDistance > aRight.sqrDistance; };
+
+	auto sqrDistanceToNode = [&aPosition](const Node& aNode)
+	{
+		const float dx = std::max(std::abs(aPosition.x - aNode.myPosition.x) - aNode.GetHalfSize(), 0.f);
+		const float dy = std::max(std::abs(aPosition.y - aNode.myPosition.y) - aNode.GetHalfSize(), 0.f);
+		return dx * dx + dy * dy;
+	};
+
+	std::vector<NodeCandidate> nodes;
+	std::vector<ObjectCandidate> nearest;
+	nearest.reserve(aCount);
+
+	// Shrinks to the distance of the worst kept object once aCount objects are found
+	float sqrSearchRadius = aMaxRadius * aMaxRadius;
+
+	// Objects crossing the edge of their root are kept in the root, so the roots are always visited
+	for (int root = 0; root < GetRootCount(); ++root)
+	{
+		nodes.push_back({ 0.f, root });
+	}
+
+	while (!nodes.empty())
+	{
+		std::pop_heap(nodes.begin(), nodes.end(), further);
+		const NodeCandidate candidate = nodes.back();
+		nodes.pop_back();
+
+		if (candidate.sqrDistance > sqrSearchRadius)
+		{
+			break;
+		}
+
+		const Node& node = myNodes[candidate.node];
+
+		ForEachObject(node, [&](const QuadTreeObject& aObject, const QuadTreeHandle)
+		{
+			const float sqrDistance = (aObject.position - aPosition).LengthSqr();
+			if (sqrDistance > sqrSearchRadius || !aFilter(aObject.id))
+			{
+				return;
+			}
+
+			if (static_cast<int>(nearest.size()) == aCount)
+			{
+				std::pop_heap(nearest.begin(), nearest.end(), closer);
+				nearest.pop_back();
+			}
+
+			nearest.push_back({ sqrDistance, aObject.id });
+			std::push_heap(nearest.begin(), nearest.end(), closer);
+
+			if (static_cast<int>(nearest.size()) == aCount)
+			{
+				sqrSearchRadius = nearest.front().sqrDistance;
+			}
+		});
+
+		if (node.IsLeaf())
+		{
+			continue;
+		}
+
+		for (int i = 0; i < 4; ++i)
+		{
+			const int childIndex = node.myFirstChild + i;
+
+			const float sqrDistance = sqrDistanceToNode(myNodes[childIndex]);
+			if (sqrDistance <= sqrSearchRadius)
+			{
+				nodes.push_back({ sqrDistance, childIndex });
+				std::push_heap(nodes.begin(), nodes.end(), further);
+			}
+		}
+	}
+
+	std::sort_heap(nearest.begin(), nearest.end(), closer);
+
+	for (const ObjectCandidate& candidate : nearest)
+	{
+		outIds.push_back(candidate.id);
+	}
+}
+
+template<int Capacity, int MaxDepth>
+inline void LooseQuadTree<Capacity, MaxDepth>::CollectPotentialPairs(std::vector<LooseQuadTreePair>& outPairs) const
+{
+	outPairs.clear();
+
+	std::vector<int> nodes;
+	GetTreeNodes(nodes);
+
+	for (int nodeIndex : nodes)
+	{
+		CollectPairs(nodeIndex, outPairs);
+	}
+}
+
+template<int Capacity, int MaxDepth>
+inline void LooseQuadTree<Capacity, MaxDepth>::CollectPotentialPairs(std::vector<LooseQuadTreePair>& outPairs, ThreadPool& aThreadPool) const
+{
+	assert(!aThreadPool.IsWorkerThread() && "Waiting on the thread pool from one of its workers can deadlock");
+
+	if (aThreadPool.Size() == 0 || aThreadPool.IsTerminated())
+	{
+		CollectPotentialPairs(outPairs);
+		return;
+	}
+
+	outPairs.clear();
+
+	std::vector<int> nodes;
+	GetTreeNodes(nodes);
+
+	const size_t batchCount = (nodes.size() + ourPairBatchSize - 1) / ourPairBatchSize;
+	std::vector<std::vector<LooseQuadTreePair>> results(batchCount);
+	std::latch done(static_cast<std::ptrdiff_t>(batchCount));
+
+	for (size_t batch = 0; batch < batchCount; ++batch)
+	{
+		aThreadPool.AddWork([this, batch, &nodes, &results, &done]()
+		{
+			const size_t end = std::min(nodes.size(), (batch + 1) * ourPairBatchSize);
+			for (size_t i = batch * ourPairBatchSize; i < end; ++i)
+			{
+				CollectPairs(nodes[i], results[batch]);
+			}
+
+			done.count_down();
+		});
+	}
+
+	done.wait();
+
+	for (const std::vector<LooseQuadTreePair>& result : results)
+	{
+		outPairs.insert(outPairs.end(), result.begin(), result.end());
+	}
+}
+
+template<int Capacity, int MaxDepth>
+template<int Count, class Function>
+inline void LooseQuadTree<Capacity, MaxDepth>::Unroll(Function&& aFunction)
+{
+	[&]<int... Index>(std::integer_sequence<int, Index...>)
+	{
+		(aFunction(Index), ...);
+	}(std::make_integer_sequence<int, Count>());
+}
+
+template<int Capacity, int MaxDepth>
+template<class Function>
+inline void LooseQuadTree<Capacity, MaxDepth>::ForEachObject(const Node& aNode, Function&& aFunction) const
+{
+	const int bucketCount = std::min(aNode.myObjectCount, Capacity);
+
+	Unroll<Capacity>([&](const int aIndex)
+	{
+		if (aIndex < bucketCount)
+		{
+			aFunction(aNode.GetBucketObject(aIndex), aNode.myHandles[aIndex]);
+		}
+	});
+
+	for (int element = aNode.myFirstOverflow; element != -1; element = myElements[element].next)
+	{
+		aFunction(myElements[element].object, myElements[element].handle);
+	}
+}
+
+/*
+	Depth first walk over the loose bounds with an explicit stack, one root at a time. Nodes completely
+	inside the shape add their whole subtree without testing the objects. The bucket
+	of a node is tested in one call over the whole arrays, unused entries are ignored afterwards.
+	Objects kept in a root can reach outside of its loose bounds, so they are always tested.
+*/
+template<int Capacity, int MaxDepth>
+template<class Shape>
+inline void LooseQuadTree<Capacity, MaxDepth>::Query(const Shape& aShape, std::vector<uint32_t>& outIds) const
+{
+	struct Entry
+	{
+		int node;
+		bool contained;
+	};
+
+	auto addObjects = [&](const Node& aNode, const bool aContained)
+	{
+		if (aNode.myObjectCount == 0)
+		{
+			return;
+		}
+
+		bool overlaps[Capacity];
+		aShape.Overlaps(aNode.myX, aNode.myY, aNode.myHalfWidths, Capacity, overlaps);
+
+		const int bucketCount = std::min(aNode.myObjectCount, Capacity);
+		for (int i = 0; i < bucketCount; ++i)
+		{
+			if (aContained || overlaps[i])
+			{
+				outIds.push_back(aNode.myIds[i]);
+			}
+		}
+
+		for (int element = aNode.myFirstOverflow; element != -1; element = myElements[element].next)
+		{
+			const QuadTreeObject& object = myElements[element].object;
+			if (aContained || aShape.Overlaps(object.position, object.halfWidth))
+			{
+				outIds.push_back(object.id);
+			}
+		}
+	};
+
+	Entry stack[ourTraversalStackSize];
+
+	for (int rootIndex = 0; rootIndex < GetRootCount(); ++rootIndex)
+	{
+		const Node& root = myNodes[rootIndex];
+		addObjects(root, false);
+
+		if (root.IsLeaf() || !aShape.Overlaps(root.myPosition, root.GetHalfSize()))
+		{
+			continue;
+		}
+
+		const bool rootContained = aShape.Contains(root.myPosition, root.GetHalfSize());
+
+		int stackSize = 0;
+		for (int i = 0; i < 4; ++i)
+		{
+			stack[stackSize++] = { root.myFirstChild + i, rootContained };
+		}
+
+		while (stackSize > 0)
+		{
+			const Entry entry = stack[--stackSize];
+			const Node& node = myNodes[entry.node];
+
+			if (!entry.contained && !aShape.Overlaps(node.myPosition, node.GetHalfSize()))
+			{
+				continue;
+			}
+
+			const bool contained = entry.contained || aShape.Contains(node.myPosition, node.GetHalfSize());
+			addObjects(node, contained);
+
+			if (node.IsLeaf())
+			{
+				continue;
+			}
+
+			for (int i = 0; i < 4; ++i)
+			{
+				stack[stackSize++] = { node.myFirstChild + i, contained };
+			}
+		}
+	}
+}
+
+template<int Capacity, int MaxDepth>
+inline int LooseQuadTree<Capacity, MaxDepth>::AllocateElement(const QuadTreeObject& aObject, const QuadTreeHandle aHandle)
+{
+	if (myFreeElement != -1)
+	{
+		int element = myFreeElement;
+		myFreeElement = myElements[element].next;
+		myElements[element] = { aObject, aHandle, -1 };
+		return element;
+	}
+
+	myElements.push_back({ aObject, aHandle, -1 });
+	return static_cast<int>(myElements.size()) - 1;
+}
+
+template<int Capacity, int MaxDepth>
+inline void LooseQuadTree<Capacity, MaxDepth>::FreeElement(const int aElement)
+{
+	myElements[aElement].handle = -1;
+	myElements[aElement].next = myFreeElement;
+	myFreeElement = aElement;
+}
+
+template<int Capacity, int MaxDepth>
+inline QuadTreeHandle LooseQuadTree<Capacity, MaxDepth>::AllocateSlot()
+{
+	if (myFreeSlot != -1)
+	{
+		QuadTreeHandle handle = myFreeSlot;
+		myFreeSlot = mySlots[handle].nextFree;
+		mySlots[handle] = { -1, -1 };
+		return handle;
+	}
+
+	mySlots.push_back({ -1, -1 });
+	return static_cast<QuadTreeHandle>(mySlots.size()) - 1;
+}
+
+template<int Capacity, int MaxDepth>
+inline void LooseQuadTree<Capacity, MaxDepth>::FreeSlot(const QuadTreeHandle aHandle)
+{
+	mySlots[aHandle] = { -1, myFreeSlot };
+	myFreeSlot = aHandle;
+}
+
+template<int Capacity, int MaxDepth>
+inline int LooseQuadTree<Capacity, MaxDepth>::AllocateChildren()
+{
+	if (myFreeChildren != -1)
+	{
+		int firstChild = myFreeChildren;
+		myFreeChildren = myNodes[firstChild].myFirstChild;
+		return firstChild;
+	}
+
+	int firstChild = static_cast<int>(myNodes.size());
+	myNodes.resize(myNodes.size() + 4);
+	return firstChild;
+}
+
+template<int Capacity, int MaxDepth>
+inline void LooseQuadTree<Capacity, MaxDepth>::FreeChildren(const int aFirstChild)
+{
+	myNodes[aFirstChild].myFirstChild = myFreeChildren;
+	myFreeChildren = aFirstChild;
+}
+
+template<int Capacity, int MaxDepth>
+inline void LooseQuadTree<Capacity, MaxDepth>::LinkObject(const int aNodeIndex, const QuadTreeObject& aObject, const QuadTreeHandle aHandle)
+{
+	Node& node = myNodes[aNodeIndex];
+
+	if (node.myObjectCount < Capacity)
+	{
+		node.SetBucketObject(node.myObjectCount, aObject, aHandle);
+	}
+	else
+	{
+		int element = AllocateElement(aObject, aHandle);
+		myElements[element].next = node.myFirstOverflow;
+		node.myFirstOverflow = element;
+	}
+
+	++node.myObjectCount;
+}
+
+template<int Capacity, int MaxDepth>
+inline QuadTreeObject LooseQuadTree<Capacity, MaxDepth>::UnlinkObject(const int aNodeIndex, const QuadTreeHandle aHandle)
+{
+	Node& node = myNodes[aNodeIndex];
+	const int bucketCount = std::min(node.myObjectCount, Capacity);
+
+	int bucketIndex = -1;
+	Unroll<Capacity>([&](const int aIndex)
+	{
+		if (aIndex < bucketCount && node.myHandles[aIndex] == aHandle)
+		{
+			bucketIndex = aIndex;
+		}
+	});
+
+	QuadTreeObject object;
+
+	if (bucketIndex != -1)
+	{
+		object = node.GetBucketObject(bucketIndex);
+
+		// Fill the hole with an overflow object so the bucket stays full while there is overflow
+		if (node.myFirstOverflow != -1)
+		{
+			const int element = node.myFirstOverflow;
+			node.SetBucketObject(bucketIndex, myElements[element].object, myElements[element].handle);
+			node.myFirstOverflow = myElements[element].next;
+			FreeElement(element);
+		}
+		else
+		{
+			node.SetBucketObject(bucketIndex, node.GetBucketObject(bucketCount - 1), node.myHandles[bucketCount - 1]);
+		}
+	}
+	else
+	{
+		int* link = &node.myFirstOverflow;
+		while (myElements[*link].handle != aHandle)
+		{
+			link = &myElements[*link].next;
+		}
+
+		const int element = *link;
+		object = myElements[element].object;
+		*link = myElements[element].next;
+		FreeElement(element);
+	}
+
+	--node.myObjectCount;
+
+	return object;
+}
+
+template<int Capacity, int MaxDepth>
+inline int LooseQuadTree<Capacity, MaxDepth>::FindRoot(const Vector2f& aPosition) const
+{
+	const int column = std::clamp(static_cast<int>(std::floor(aPosition.x / myRootSize)), 0, myRootColumns - 1);
+	const int row = std::clamp(static_cast<int>(std::floor(aPosition.y / myRootSize)), 0, myRootRows - 1);
+
+	return row * myRootColumns + column;
+}
+
+template<int Capacity, int MaxDepth>
+inline int LooseQuadTree<Capacity, MaxDepth>::FindChild(const Node& aNode, const QuadTreeObject& aObject) const
+{
+	if (myAdaptiveLooseness)
+	{
+		// Only a root can be asked about an object whose center is outside it
+		if (GetTargetDepth(aObject.halfWidth) <= aNode.myDepth || !aNode.contains(aObject.position))
+		{
+			return -1;
+		}
+
+		return FindQuadrantChild(aNode, aObject.position);
+	}
+
+	const int child = FindClosestChild(aNode, aObject);
+	return myNodes[child].Inside(aObject) ? child : -1;
+}
+
+template<int Capacity, int MaxDepth>
+inline int LooseQuadTree<Capacity, MaxDepth>::FindClosestChild(const Node& aNode, const QuadTreeObject& aObject) const
+{
+	int closest = -1;
+	float minSqrDistance = FLT_MAX;
+
+	for (int i = 0; i < 4; ++i)
+	{
+		float sqrDistance = (myNodes[aNode.myFirstChild + i].GetPosition() - aObject.position).LengthSqr();
+		if (sqrDistance < minSqrDistance)
+		{
+			closest = aNode.myFirstChild + i;
+			minSqrDistance = sqrDistance;
+		}
+	}
+
+	return closest;
+}
+
+template<int Capacity, int MaxDepth>
+inline int LooseQuadTree<Capacity, MaxDepth>::FindQuadrantChild(const Node& aNode, const Vector2f& aPosition) const
+{
+	const bool right = aPosition.x >= aNode.myPosition.x;
+	const bool top = aPosition.y >= aNode.myPosition.y;
+
+	return aNode.myFirstChild + (top ? (right ? 1 : 0) : (right ? 2 : 3));
+}
+
+template<int Capacity, int MaxDepth>
+inline int LooseQuadTree<Capacity, MaxDepth>::FindInsertNode(const int aStartNode, const QuadTreeObject& aObject) const
+{
+	int nodeIndex = aStartNode;
+	while (!myNodes[nodeIndex].IsLeaf())
+	{
+		int child = FindChild(myNodes[nodeIndex], aObject);
+		if (child == -1)
+		{
+			break;
+		}
+
+		nodeIndex = child;
+	}
+
+	return nodeIndex;
+}
+
+template<int Capacity, int MaxDepth>
+inline int LooseQuadTree<Capacity, MaxDepth>::GetTargetDepth(const float aHalfWidth) const
+{
+	const float rootHalfWidth = myRootSize * 0.5f;
+	if (aHalfWidth <= 0.f)
+	{
+		return MaxDepth;
+	}
+
+	if (aHalfWidth >= rootHalfWidth)
+	{
+		return 0;
+	}
+
+	// Node half widths are exact halvings of the root's, so the rounded log is fixed up against them
+	int depth = std::min(std::ilogb(rootHalfWidth / aHalfWidth), MaxDepth);
+	if (depth > 0 && aHalfWidth > std::ldexp(rootHalfWidth, -depth))
+	{
+		--depth;
+	}
+
+	return depth;
+}
+
+template<int Capacity, int MaxDepth>
+inline bool LooseQuadTree<Capacity, MaxDepth>::ShouldSplit(const Node& aNode) const
+{
+	return aNode.IsLeaf() && aNode.myObjectCount > Capacity && aNode.myDepth < MaxDepth;
+}
+
+template<int Capacity, int MaxDepth>
+inline void LooseQuadTree<Capacity, MaxDepth>::CreateChildren(const int aNodeIndex)
+{
+	// Allocating can reallocate the node array, so only hold references after it
+	const int firstChild = AllocateChildren();
+
+	const Vector2f position = myNodes[aNodeIndex].myPosition;
+	const float halfWidthChildren = myNodes[aNodeIndex].myHalfWidth * 0.5f;
+	const int depthChildren = myNodes[aNodeIndex].myDepth + 1;
+
+	for (int i = 0; i < 4; ++i)
+	{
+		Node& child = myNodes[firstChild + i];
+		child = Node();
+		child.myHalfWidth = halfWidthChildren;
+		child.myLoosenessfactor = myLoosenessfactor;
+		child.myParent = aNodeIndex;
+		child.myDepth = depthChildren;
+	}
+
+	myNodes[firstChild + 0].myPosition = { position.x - halfWidthChildren, position.y + halfWidthChildren };
+	myNodes[firstChild + 1].myPosition = { position.x + halfWidthChildren, position.y + halfWidthChildren };
+	myNodes[firstChild + 2].myPosition = { position.x + halfWidthChildren, position.y - halfWidthChildren };
+	myNodes[firstChild + 3].myPosition = { position.x - halfWidthChildren, position.y - halfWidthChildren };
+
+	myNodes[aNodeIndex].myFirstChild = firstChild;
+
+	// Take the objects out of the node and link them again, objects that do not fit in any child stay in this node
+	const Node bucket = myNodes[aNodeIndex];
+	const int bucketCount = std::min(bucket.myObjectCount, Capacity);
+
+	myNodes[aNodeIndex].myFirstOverflow = -1;
+	myNodes[aNodeIndex].myObjectCount = 0;
+
+	auto relink = [&](const QuadTreeObject& aObject, const QuadTreeHandle aHandle)
+	{
+		int child = FindChild(myNodes[aNodeIndex], aObject);
+		int target = child != -1 ? child : aNodeIndex;
+
+		LinkObject(target, aObject, aHandle);
+		mySlots[aHandle].node = target;
+	};
+
+	for (int i = 0; i < bucketCount; ++i)
+	{
+		relink(bucket.GetBucketObject(i), bucket.myHandles[i]);
+	}
+
+	int element = bucket.myFirstOverflow;
+	while (element != -1)
+	{
+		const LooseQuadTreeElement overflow = myElements[element];
+
+		FreeElement(element);
+		relink(overflow.object, overflow.handle);
+
+		element = overflow.next;
+	}
+
+	for (int i = 0; i < 4; ++i)
+	{
+		if (ShouldSplit(myNodes[firstChild + i]))
+		{
+			CreateChildren(firstChild + i);
+		}
+	}
+}
+
+template<int Capacity, int MaxDepth>
+inline void LooseQuadTree<Capacity, MaxDepth>::TryCollapse(const int aNodeIndex)
+{
+	int nodeIndex = myNodes[aNodeIndex].IsLeaf() ? myNodes[aNodeIndex].myParent : aNodeIndex;
+
+	while (nodeIndex != -1 && Collapse(nodeIndex))
+	{
+		nodeIndex = myNodes[nodeIndex].myParent;
+	}
+}
+
+template<int Capacity, int MaxDepth>
+inline bool LooseQuadTree<Capacity, MaxDepth>::Collapse(const int aNodeIndex)
+{
+	const int firstChild = myNodes[aNodeIndex].myFirstChild;
+	int objectCount = myNodes[aNodeIndex].myObjectCount;
+
+	for (int i = 0; i < 4; ++i)
+	{
+		const Node& child = myNodes[firstChild + i];
+		if (!child.IsLeaf())
+		{
+			return false;
+		}
+
+		objectCount += child.myObjectCount;
+	}
+
+	if (objectCount > Capacity)
+	{
+		return false;
+	}
+
+	// Everything fits in one bucket, so none of the children have overflow
+	for (int i = 0; i < 4; ++i)
+	{
+		const Node& child = myNodes[firstChild + i];
+		for (int j = 0; j < child.myObjectCount; ++j)
+		{
+			LinkObject(aNodeIndex, child.GetBucketObject(j), child.myHandles[j]);
+			mySlots[child.myHandles[j]].node = aNodeIndex;
+		}
+	}
+
+	myNodes[aNodeIndex].myFirstChild = -1;
+	FreeChildren(firstChild);
+
+	return true;
+}
+
+template<int Capacity, int MaxDepth>
+inline void LooseQuadTree<Capacity, MaxDepth>::GetTreeNodes(std::vector<int>& outNodes) const
+{
+	for (int root = 0; root < GetRootCount(); ++root)
+	{
+		outNodes.push_back(root);
+	}
+
+	for (size_t i = 0; i < outNodes.size(); ++i)
+	{
+		const Node& node = myNodes[outNodes[i]];
+		if (!node.IsLeaf())
+		{
+			for (int child = 0; child < 4; ++child)
+			{
+				outNodes.push_back(node.myFirstChild + child);
+			}
+		}
+	}
+}
+
+/*
+	Loose bounds of siblings overlap, so objects can overlap objects in any node whose loose bounds overlap
+	their own node's, not only the ancestors. Children's loose bounds are inside their parent's for a looseness
+	of at least one, which lets the walk skip every subtree whose root does not overlap the node.
+	Comparing indices makes sure that each pair of nodes is only tested from one of them.
+	Objects of other nodes are tested against the whole bucket of this node in one pass over its arrays.
+	Objects kept in a root can reach outside of its loose bounds, so a root is walked with the bounds of its objects
+	and the objects of the other roots are always tested.
+*/
+template<int Capacity, int MaxDepth>
+inline void LooseQuadTree<Capacity, MaxDepth>::CollectPairs(const int aNodeIndex, std::vector<LooseQuadTreePair>& outPairs) const
+{
+	const Node& node = myNodes[aNodeIndex];
+	if (node.myObjectCount == 0)
+	{
+		return;
+	}
+
+	const int bucketCount = std::min(node.myObjectCount, Capacity);
+
+	Vector2f min = { node.myPosition.x - node.GetHalfSize(), node.myPosition.y - node.GetHalfSize() };
+	Vector2f max = { node.myPosition.x + node.GetHalfSize(), node.myPosition.y + node.GetHalfSize() };
+
+	// Pairs inside the node, each object is tested against the objects visited before it
+	int index = 0;
+	ForEachObject(node, [&](const QuadTreeObject& aObject, const QuadTreeHandle)
+	{
+		int otherIndex = 0;
+		ForEachObject(node, [&](const QuadTreeObject& aOther, const QuadTreeHandle)
+		{
+			if (otherIndex++ < index && Overlaps(aObject.position, aObject.halfWidth, aOther.position, aOther.halfWidth))
+			{
+				outPairs.push_back({ aOther.id, aObject.id });
+			}
+		});
+
+		if (aNodeIndex < GetRootCount())
+		{
+			min.x = std::min(min.x, aObject.position.x - aObject.halfWidth);
+			min.y = std::min(min.y, aObject.position.y - aObject.halfWidth);
+			max.x = std::max(max.x, aObject.position.x + aObject.halfWidth);
+			max.y = std::max(max.y, aObject.position.y + aObject.halfWidth);
+		}
+
+		++index;
+	});
+
+	auto overlapsNode = [&min, &max](const Node& aOther)
+	{
+		const float halfSize = aOther.GetHalfSize();
+
+		return aOther.myPosition.x + halfSize >= min.x && aOther.myPosition.x - halfSize <= max.x &&
+			   aOther.myPosition.y + halfSize >= min.y && aOther.myPosition.y - halfSize <= max.y;
+	};
+
+	auto testObjects = [&](const Node& aOther)
+	{
+		ForEachObject(aOther, [&](const QuadTreeObject& aOtherObject, const QuadTreeHandle)
+		{
+			bool overlaps[Capacity];
+			for (int i = 0; i < Capacity; ++i)
+			{
+				const float halfWidths = node.myHalfWidths[i] + aOtherObject.halfWidth;
+				overlaps[i] = (std::abs(node.myX[i] - aOtherObject.position.x) <= halfWidths) & (std::abs(node.myY[i] - aOtherObject.position.y) <= halfWidths);
+			}
+
+			for (int i = 0; i < bucketCount; ++i)
+			{
+				if (overlaps[i])
+				{
+					outPairs.push_back({ node.myIds[i], aOtherObject.id });
+				}
+			}
+
+			for (int element = node.myFirstOverflow; element != -1; element = myElements[element].next)
+			{
+				const QuadTreeObject& object = myElements[element].object;
+				if (Overlaps(object.position, object.halfWidth, aOtherObject.position, aOtherObject.halfWidth))
+				{
+					outPairs.push_back({ object.id, aOtherObject.id });
+				}
+			}
+		});
+	};
+
+	int stack[ourTraversalStackSize];
+
+	for (int rootIndex = 0; rootIndex < GetRootCount(); ++rootIndex)
+	{
+		const Node& root = myNodes[rootIndex];
+		if (rootIndex > aNodeIndex)
+		{
+			testObjects(root);
+		}
+
+		if (root.IsLeaf() || !overlapsNode(root))
+		{
+			continue;
+		}
+
+		int stackSize = 0;
+		for (int i = 0; i < 4; ++i)
+		{
+			stack[stackSize++] = root.myFirstChild + i;
+		}
+
+		while (stackSize > 0)
+		{
+			const int otherIndex = stack[--stackSize];
+			const Node& other = myNodes[otherIndex];
+
+			if (!overlapsNode(other))
+			{
+				continue;
+			}
+
+			if (otherIndex > aNodeIndex)
+			{
+				testObjects(other);
+			}
+
+			if (!other.IsLeaf())
+			{
+				for (int i = 0; i < 4; ++i)
+				{
+					stack[stackSize++] = other.myFirstChild + i;
+				}
+			}
+		}
+	}
+}
+
+template<int Capacity, int MaxDepth>
+inline bool LooseQuadTree<Capacity, MaxDepth>::Overlaps(const Vector2f& aFirstCenter, const float aFirstHalfWidth, const Vector2f& aSecondCenter, const float aSecondHalfWidth)
+{
+	const float halfWidths = aFirstHalfWidth + aSecondHalfWidth;
 
-		LooseQuadTreeNode myRoot;
-};
\ No newline at end of file
+	return std::abs(aFirstCenter.x - aSecondCenter.x) <= halfWidths && std::abs(aFirstCenter.y - aSecondCenter.y) <= halfWidths;
+}
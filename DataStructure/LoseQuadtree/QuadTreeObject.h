@@ -1,11 +1,13 @@
-#include <Math/vector2.h>
-#include <Sprite/sprite.h>
+#pragma once
 
+#include <Math/Vector2.h>
+
+#include <cstdint>
+
+// Bounds of an object in the tree, the object's own data is kept by the user and looked up with id
 struct QuadTreeObject
 {
 	Vector2f position;
 	float halfWidth;
-
-	SpriteSharedData* spriteSharedData;
-	Sprite2DInstanceData spriteInstanceData;
-};
\ No newline at end of file
+	uint32_t id;
+};
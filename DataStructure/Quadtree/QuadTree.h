@@ -1,77 +1,1332 @@
 #pragma once
 
 #include "QuadTreeObject.h"
+#include "../../Pool/Thread/ThreadPool.h"
 
 #include <Math/Vector2.h>
+#include <Collision/AABB2D.h>
+#include <Collision/Circle.h>
+#include <Collision/Frustum2D.h>
 
+#include <span>
+#include <latch>
+#include <cmath>
 #include <vector>
+#include <utility>
+#include <cstdint>
+#include <climits>
+#include <algorithm>
+#include <assert.h>
 
+using AABB2Df = CommonUtilities::AABB2D<float>;
+using Circlef = CommonUtilities::Circle<float>;
+using Frustum2Df = CommonUtilities::Frustum2D<float>;
 
+template <int Capacity, int MaxDepth>
 class QuadTree;
 
+// Stable reference to an inserted object, valid until the object is removed
+using QuadTreeHandle = int;
+
+template <int Capacity>
 class QuadTreeNode
 {
+	template <int, int>
 	friend class QuadTree;
 
 	public:
 		QuadTreeNode() = default;
-		~QuadTreeNode();
 
-		inline const std::vector<QuadTreeNode*>& GetChildren() const { return myChildren; }
-		inline std::vector<QuadTreeObject*> GetObjects() { return myObjects; }
+		inline const Vector2f& GetPosition() const { return myPosition; }
+		inline float GetHalfWidth() const { return myHalfWidth; }
+
+		// Index of the first of the four adjacent children, children are stored in the order top left, top right, bottom right, bottom left
+		inline int GetFirstChild() const { return myFirstChild; }
+		inline int GetParent() const { return myParent; }
+		inline int GetDepth() const { return myDepth; }
+		inline int GetObjectCount() const { return myObjectCount; }
+		inline bool IsLeaf() const { return myFirstChild == -1; }
 
-		bool contains(Vector2f aPosition);
+		bool contains(Vector2f aPosition) const;
 
 	private:
-		bool Insert(QuadTreeObject& aObject);
-		bool Inside(QuadTreeObject& aObject);
+		bool Inside(const QuadTreeObject& aObject) const;
 
-		void CreateChildren();
+		QuadTreeObject GetBucketObject(const int aIndex) const;
+		void SetBucketObject(const int aIndex, const QuadTreeObject& aObject, const QuadTreeHandle aHandle);
 
 	private:
 		Vector2f myPosition;
-		float myHalfWidth;
-		bool myDivided;
+		float myHalfWidth = 0.f;
+
+		int myParent = -1;
+		int myFirstChild = -1;
+		int myDepth = 0;
+		int myObjectCount = 0;
 
-		static const int myCapacity = 4;
+		// The first Capacity objects live in the node, the rest in an overflow list in the element pool
+		int myFirstOverflow = -1;
 
-		std::vector<QuadTreeNode*> myChildren;
-		std::vector<QuadTreeObject*> myObjects;
+		// Bucket stored as one array per field so the leaf tests can check several objects at a time
+		float myX[Capacity] = {};
+		float myY[Capacity] = {};
+		float myHalfWidths[Capacity] = {};
+		uint32_t myIds[Capacity] = {};
+		QuadTreeHandle myHandles[Capacity] = {};
 };
 
+// Object that did not fit in the bucket of its node, linked to the next overflow object of the same node
+struct QuadTreeElement
+{
+	QuadTreeObject object;
+	QuadTreeHandle handle;
+	int next;
+};
 
+// The node a handle is stored in, node is -1 for free slots which use nextFree to link the free list
+struct QuadTreeSlot
+{
+	int node;
+	int nextFree;
+};
+
+
+/*
+	All nodes live in one contiguous array and are addressed by index, the root is always node 0.
+	The tree only stores the bounds and id of each object, the rest of the object's data stays with the user.
+	Each node stores up to Capacity objects inline. Leaves only overflow that bucket at MaxDepth,
+	inner nodes overflow with objects that do not fit in any of their children.
+	Node pointers handed out by GetIntersected are only valid until the tree is modified.
+	Children of collapsed nodes are put on a free list and reused by the next split.
+*/
+template <int Capacity = 8, int MaxDepth = 16>
 class QuadTree
 {
+	static_assert(Capacity > 0, "A node needs room for at least one object");
+	static_assert(MaxDepth > 0 && MaxDepth <= 16, "Build sorts on 16 bit Morton keys per axis, which limits the depth to 16");
 
 	public:
+		using Node = QuadTreeNode<Capacity>;
+
 		QuadTree() = default;
 		~QuadTree() = default;
 
 		void Init(const float aWidth, const float aHeight);
 
-		void Render(DebugDrawer& aDebugDrawer)
-		{
-			Render(aDebugDrawer, myRoot);
-		}
+		// Removes all nodes and objects but keeps the allocated memory for the next build
+		void Clear();
 
-		void Insert(QuadTreeObject& aObject)
-		{
-			myRoot.Insert(aObject);
-		}
+		// Replaces the content of the tree with someObjects, the handle of someObjects[i] is i.
+		// Objects are sorted along a Morton curve and the nodes are emitted in one pass over the sorted list.
+		void Build(std::span<const QuadTreeObject> someObjects);
+
+		// Same result as Build, the subtrees below the top levels are built on the pool and spliced into the node array.
+		// Builds on the calling thread when the pool has no threads or is terminated, must not be called from a worker of the pool.
+		void Build(std::span<const QuadTreeObject> someObjects, ThreadPool& aThreadPool);
+
+		template <class Drawer>
+		void Render(Drawer& aDebugDrawer) const;
+
+		// Stores a copy of the object's bounds and id, returns -1 if the object is outside the tree
+		QuadTreeHandle Insert(const QuadTreeObject& aObject);
+
+		// Removes the object and collapses nodes whose children hold no more than the capacity
+		void Remove(const QuadTreeHandle aHandle);
+
+		// Moves the object, it is only moved to another node when it leaves the bounds of its current node
+		void Update(const QuadTreeHandle aHandle, const Vector2f& aNewPosition);
+
+		QuadTreeObject GetObject(const QuadTreeHandle aHandle) const;
+
+		void GetIntersected(Vector2f aPosition, std::vector<Node*>& outIntersected);
+
+		void GetObjects(const Node& aNode, std::vector<uint32_t>& outIds) const;
 
-		void GetIntersected(Vector2f aPosition, std::vector<QuadTreeNode*>& outIntersected);
+		// Appends the id of every object touching the query area to outIds, the buffer is not cleared
+		void QueryRect(const AABB2Df& aRect, std::vector<uint32_t>& outIds) const { Query(aRect, outIds); }
+		void QueryCircle(const Circlef& aCircle, std::vector<uint32_t>& outIds) const { Query(aCircle, outIds); }
+		void QueryFrustum2D(const Frustum2Df& aFrustum, std::vector<uint32_t>& outIds) const { Query(aFrustum, outIds); }
+
+		// Appends the ids of the aCount objects closest to aPosition and no further away than aMaxRadius to outIds, closest first.
+		// Nodes are visited in order of distance so the search ends as soon as no unvisited node can hold a closer object.
+		void FindNearest(const Vector2f& aPosition, const int aCount, const float aMaxRadius, std::vector<uint32_t>& outIds) const;
+
+		// Same as above but only objects accepted by aFilter, a bool(uint32_t aId) predicate, are returned
+		template <class Filter>
+		void FindNearest(const Vector2f& aPosition, const int aCount, const float aMaxRadius, std::vector<uint32_t>& outIds, Filter&& aFilter) const;
+
+		// Runs the queries on the pool, the result of someShapes[i] is outIds[outOffsets[i]] up to outIds[outOffsets[i + 1]].
+		// Shape is AABB2Df, Circlef or Frustum2Df. Both buffers are overwritten.
+		// Queries on the calling thread when the pool can not run work, and like Build must not be called from one of its workers.
+		template <class Shape>
+		void QueryBatch(std::span<const Shape> someShapes, ThreadPool& aThreadPool, std::vector<uint32_t>& outIds, std::vector<int>& outOffsets) const;
+
+		inline const std::vector<Node>& GetNodes() const { return myNodes; }
+		inline const Node& GetRoot() const { return myNodes[0]; }
 
 	private:
+		struct BuildRange
+		{
+			int node;
+			int depth;
+			size_t begin;
+			size_t end;
+		};
+
+		// A depth first walk keeps at most three unvisited siblings per level on the stack
+		static constexpr int ourTraversalStackSize = 3 * MaxDepth + 4;
+
+		// Subtrees are handed to the pool down to this depth, smaller ranges are built by the calling thread
+		static constexpr int ourParallelBuildDepth = MaxDepth < 3 ? MaxDepth : 3;
+		static constexpr size_t ourParallelBuildMinObjects = 4096;
+
+		// Queries per task in QueryBatch
+		static constexpr size_t ourQueryBatchSize = 64;
+
+		// Number of bits per axis in the Morton keys
+		static constexpr int ourMortonBits = 16;
+
+		// Calls aFunction with 0 to Count - 1, unrolled at compile time
+		template <int Count, class Function>
+		static void Unroll(Function&& aFunction);
+
+		// Calls aFunction with every object and its handle in aNode, the bucket part is unrolled
+		template <class Function>
+		void ForEachObject(const Node& aNode, Function&& aFunction) const;
+
+		template <class Shape>
+		void Query(const Shape& aShape, std::vector<uint32_t>& outIds) const;
+
+		int AllocateElement(const QuadTreeObject& aObject, const QuadTreeHandle aHandle);
+		void FreeElement(const int aElement);
+
+		QuadTreeHandle AllocateSlot();
+		void FreeSlot(const QuadTreeHandle aHandle);
+
+		int AllocateChildren();
+		void FreeChildren(const int aFirstChild);
+
+		void LinkObject(const int aNodeIndex, const QuadTreeObject& aObject, const QuadTreeHandle aHandle);
+
+		// Removes the handle from the node and returns the object that was stored for it
+		QuadTreeObject UnlinkObject(const int aNodeIndex, const QuadTreeHandle aHandle);
+
+		int FindChild(const Node& aNode, const QuadTreeObject& aObject) const;
+		int FindInsertNode(const int aStartNode, const QuadTreeObject& aObject) const;
+
+		bool ShouldSplit(const Node& aNode) const;
+
+		void CreateChildren(const int aNodeIndex);
+		void InitChildren(const int aNodeIndex, const int aFirstChild);
+
+		void ComputeSortKeys(std::span<const QuadTreeObject> someObjects);
+
+		// Builds the ranges on the stack, ranges deeper than aDeferDepth with more than aDeferObjects objects go to outDeferred instead
+		void BuildNodes(std::span<const QuadTreeObject> someObjects, std::span<uint64_t> someKeys, std::vector<BuildRange>& aStack,
+			const int aDeferDepth = INT_MAX, const size_t aDeferObjects = 0, std::vector<BuildRange>* outDeferred = nullptr);
 
-		void Render(DebugDrawer& aDebugDrawer, QuadTreeNode& aNode);
+		// Moves the nodes and elements of aSubtree below aNodeIndex, the subtree root becomes aNodeIndex
+		void Splice(const int aNodeIndex, const QuadTree& aSubtree);
 
-		void SearchIntersected(QuadTreeNode* aNode, Vector2f& aPosition, std::vector<QuadTreeNode*>& outIntersected);
+		void AssignSlots(const size_t aObjectCount);
+
+		void TryCollapse(const int aNodeIndex);
+		bool Collapse(const int aNodeIndex);
+
+		static uint32_t SpreadBits(uint32_t aValue);
+		static uint32_t MortonKey(const float aX, const float aY);
+
+		// LSD radix sort on the high 32 bits, 8 bits per pass, stable so equal keys keep their object order
+		static void RadixSort(std::vector<uint64_t>& someKeys, std::vector<uint64_t>& someScratch);
 
 	private:
 		float myWidth;
 		float myHeight;
-		int myCapacity;
 
-		QuadTreeNode myRoot;
+		std::vector<Node> myNodes;
+		std::vector<QuadTreeElement> myElements;
+		std::vector<QuadTreeSlot> mySlots;
+
+		int myFreeElement = -1;
+		int myFreeSlot = -1;
+		int myFreeChildren = -1;
+
+		// Morton key in the high 32 bits and object index in the low 32 bits, kept between builds
+		std::vector<uint64_t> mySortKeys;
+		std::vector<uint64_t> mySortScratch;
+
+};
+
+template<int Capacity>
+inline bool QuadTreeNode<Capacity>::contains(Vector2f aPosition) const
+{
+	Vector2f min = { myPosition.x - myHalfWidth, myPosition.y - myHalfWidth };
+	Vector2f max = { myPosition.x + myHalfWidth, myPosition.y + myHalfWidth };
+
+	return aPosition.x >= min.x && aPosition.y >= min.y && aPosition.x <= max.x && aPosition.y <= max.y;
+}
+
+template<int Capacity>
+inline bool QuadTreeNode<Capacity>::Inside(const QuadTreeObject& aObject) const
+{
+	bool insideX = std::abs(aObject.position.x - myPosition.x) < myHalfWidth - aObject.halfWidth;
+	bool insideY = std::abs(aObject.position.y - myPosition.y) < myHalfWidth - aObject.halfWidth;
+
+	return insideX && insideY;
+}
+
+template<int Capacity>
+inline QuadTreeObject QuadTreeNode<Capacity>::GetBucketObject(const int aIndex) const
+{
+	return { { myX[aIndex], myY[aIndex] }, myHalfWidths[aIndex], myIds[aIndex] };
+}
+
+template<int Capacity>
+inline void QuadTreeNode<Capacity>::SetBucketObject(const int aIndex, const QuadTreeObject& aObject, const QuadTreeHandle aHandle)
+{
+	myX[aIndex] = aObject.position.x;
+	myY[aIndex] = aObject.position.y;
+	myHalfWidths[aIndex] = aObject.halfWidth;
+	myIds[aIndex] = aObject.id;
+	myHandles[aIndex] = aHandle;
+}
+
+template<int Capacity, int MaxDepth>
+inline void QuadTree<Capacity, MaxDepth>::Init(const float aWidth, const float aHeight)
+{
+	myWidth = aWidth;
+	myHeight = aHeight;
+
+	Clear();
+}
+
+template<int Capacity, int MaxDepth>
+inline void QuadTree<Capacity, MaxDepth>::Clear()
+{
+	myNodes.clear();
+	myElements.clear();
+	mySlots.clear();
+
+	myFreeElement = -1;
+	myFreeSlot = -1;
+	myFreeChildren = -1;
+
+	Node root;
+	root.myHalfWidth = myWidth * 0.5f;
+	root.myPosition.x = root.myHalfWidth;
+	root.myPosition.y = root.myHalfWidth;
+
+	myNodes.push_back(root);
+}
+
+template<int Capacity, int MaxDepth>
+inline QuadTreeHandle QuadTree<Capacity, MaxDepth>::Insert(const QuadTreeObject& aObject)
+{
+	if (!myNodes[0].Inside(aObject))
+	{
+		return -1;
+	}
+
+	QuadTreeHandle handle = AllocateSlot();
+	int nodeIndex = FindInsertNode(0, aObject);
+
+	LinkObject(nodeIndex, aObject, handle);
+	mySlots[handle].node = nodeIndex;
+
+	if (ShouldSplit(myNodes[nodeIndex]))
+	{
+		CreateChildren(nodeIndex);
+	}
+
+	return handle;
+}
+
+template<int Capacity, int MaxDepth>
+inline void QuadTree<Capacity, MaxDepth>::Remove(const QuadTreeHandle aHandle)
+{
+	const int nodeIndex = mySlots[aHandle].node;
+	assert(nodeIndex != -1 && "Removing a handle that is not in the tree");
+
+	UnlinkObject(nodeIndex, aHandle);
+	FreeSlot(aHandle);
+
+	TryCollapse(nodeIndex);
+}
+
+template<int Capacity, int MaxDepth>
+inline void QuadTree<Capacity, MaxDepth>::Update(const QuadTreeHandle aHandle, const Vector2f& aNewPosition)
+{
+	const int oldNode = mySlots[aHandle].node;
+	assert(oldNode != -1 && "Updating a handle that is not in the tree");
+
+	QuadTreeObject object = UnlinkObject(oldNode, aHandle);
+	object.position = aNewPosition;
+
+	if (myNodes[oldNode].Inside(object))
+	{
+		LinkObject(oldNode, object, aHandle);
+		return;
+	}
+
+	// Walk up to the first node that still holds the object, objects leaving the tree are kept in the root
+	int ancestor = myNodes[oldNode].myParent;
+	while (ancestor != -1 && !myNodes[ancestor].Inside(object))
+	{
+		ancestor = myNodes[ancestor].myParent;
+	}
+
+	int nodeIndex = FindInsertNode(ancestor != -1 ? ancestor : 0, object);
+
+	LinkObject(nodeIndex, object, aHandle);
+	mySlots[aHandle].node = nodeIndex;
+
+	if (ShouldSplit(myNodes[nodeIndex]))
+	{
+		CreateChildren(nodeIndex);
+	}
+
+	TryCollapse(oldNode);
+}
+
+template<int Capacity, int MaxDepth>
+inline QuadTreeObject QuadTree<Capacity, MaxDepth>::GetObject(const QuadTreeHandle aHandle) const
+{
+	assert(mySlots[aHandle].node != -1 && "Getting a handle that is not in the tree");
+
+	QuadTreeObject result = {};
+	ForEachObject(myNodes[mySlots[aHandle].node], [&](const QuadTreeObject& aObject, const QuadTreeHandle aObjectHandle)
+	{
+		if (aObjectHandle == aHandle)
+		{
+			result = aObject;
+		}
+	});
+
+	return result;
+}
+
+template<int Capacity, int MaxDepth>
+inline void QuadTree<Capacity, MaxDepth>::Build(std::span<const QuadTreeObject> someObjects)
+{
+	Clear();
+	ComputeSortKeys(someObjects);
+
+	std::vector<BuildRange> stack = { { 0, 0, 0, mySortKeys.size() } };
+	BuildNodes(someObjects, mySortKeys, stack);
+
+	AssignSlots(someObjects.size());
+}
+
+template<int Capacity, int MaxDepth>
+inline void QuadTree<Capacity, MaxDepth>::Build(std::span<const QuadTreeObject> someObjects, ThreadPool& aThreadPool)
+{
+	assert(!aThreadPool.IsWorkerThread() && "Waiting on the thread pool from one of its workers can deadlock");
+
+	if (aThreadPool.Size() == 0 || aThreadPool.IsTerminated())
+	{
+		Build(someObjects);
+		return;
+	}
+
+	Clear();
+	ComputeSortKeys(someObjects);
+
+	// Build the top levels here and collect the large ranges below them
+	std::vector<BuildRange> stack = { { 0, 0, 0, mySortKeys.size() } };
+	std::vector<BuildRange> deferred;
+	BuildNodes(someObjects, mySortKeys, stack, ourParallelBuildDepth, ourParallelBuildMinObjects, &deferred);
+
+	// Every subtree works on its own run of keys and its own tree, so nothing is shared between the tasks
+	std::vector<QuadTree> subtrees(deferred.size());
+	std::latch done(static_cast<std::ptrdiff_t>(deferred.size()));
+
+	for (size_t i = 0; i < deferred.size(); ++i)
+	{
+		QuadTree& subtree = subtrees[i];
+
+		Node root = myNodes[deferred[i].node];
+		root.myParent = -1;
+		subtree.myNodes.push_back(root);
+
+		aThreadPool.AddWork([&subtree, &done, range = deferred[i], someObjects, this]()
+		{
+			std::vector<BuildRange> subtreeStack = { { 0, range.depth, range.begin, range.end } };
+			subtree.BuildNodes(someObjects, mySortKeys, subtreeStack);
+
+			done.count_down();
+		});
+	}
+
+	done.wait();
+
+	size_t nodeCount = myNodes.size();
+	size_t elementCount = myElements.size();
+	for (const QuadTree& subtree : subtrees)
+	{
+		nodeCount += subtree.myNodes.size() - 1;
+		elementCount += subtree.myElements.size();
+	}
+
+	myNodes.reserve(nodeCount);
+	myElements.reserve(elementCount);
+
+	for (size_t i = 0; i < deferred.size(); ++i)
+	{
+		Splice(deferred[i].node, subtrees[i]);
+	}
+
+	AssignSlots(someObjects.size());
+}
+
+template<int Capacity, int MaxDepth>
+template<class Drawer>
+inline void QuadTree<Capacity, MaxDepth>::Render(Drawer& aDebugDrawer) const
+{
+	// Walk from the root since freed children are still in the node array
+	std::vector<int> stack = { 0 };
+
+	while (!stack.empty())
+	{
+		const Node& node = myNodes[stack.back()];
+		stack.pop_back();
+
+		float minX = node.myPosition.x - node.myHalfWidth;
+		float minY = node.myPosition.y - node.myHalfWidth;
+
+		float maxX = node.myPosition.x + node.myHalfWidth;
+		float maxY = node.myPosition.y + node.myHalfWidth;
+
+		aDebugDrawer.DrawLine({ minX, maxY }, { maxX, maxY });
+		aDebugDrawer.DrawLine({ maxX, maxY }, { maxX, minY });
+		aDebugDrawer.DrawLine({ maxX, minY }, { minX, minY });
+		aDebugDrawer.DrawLine({ minX, minY }, { minX, maxY });
+
+		if (!node.IsLeaf())
+		{
+			for (int i = 0; i < 4; ++i)
+			{
+				stack.push_back(node.myFirstChild + i);
+			}
+		}
+	}
+}
+
+template<int Capacity, int MaxDepth>
+inline void QuadTree<Capacity, MaxDepth>::GetIntersected(Vector2f aPosition, std::vector<Node*>& outIntersected)
+{
+	int nodeIndex = 0;
+	outIntersected.push_back(&myNodes[nodeIndex]);
+
+	while (!myNodes[nodeIndex].IsLeaf())
+	{
+		int firstChild = myNodes[nodeIndex].myFirstChild;
+		nodeIndex = -1;
+
+		for (int i = 0; i < 4; ++i)
+		{
+			if (myNodes[firstChild + i].contains(aPosition))
+			{
+				nodeIndex = firstChild + i;
+				break;
+			}
+		}
+
+		if (nodeIndex == -1)
+		{
+			return;
+		}
+
+		outIntersected.push_back(&myNodes[nodeIndex]);
+	}
+}
+
+template<int Capacity, int MaxDepth>
+inline void QuadTree<Capacity, MaxDepth>::GetObjects(const Node& aNode, std::vector<uint32_t>& outIds) const
+{
+	ForEachObject(aNode, [&](const QuadTreeObject& aObject, const QuadTreeHandle)
+	{
+		outIds.push_back(aObject.id);
+	});
+}
+
+template<int Capacity, int MaxDepth>
+template<class Shape>
+inline void QuadTree<Capacity, MaxDepth>::QueryBatch(std::span<const Shape> someShapes, ThreadPool& aThreadPool, std::vector<uint32_t>& outIds, std::vector<int>& outOffsets) const
+{
+	struct BatchResult
+	{
+		std::vector<uint32_t> ids;
+		std::vector<int> counts;
+	};
+
+	assert(!aThreadPool.IsWorkerThread() && "Waiting on the thread pool from one of its workers can deadlock");
+
+	if (aThreadPool.Size() == 0 || aThreadPool.IsTerminated())
+	{
+		outIds.clear();
+		outOffsets.clear();
+		outOffsets.reserve(someShapes.size() + 1);
+		outOffsets.push_back(0);
+
+		for (const Shape& shape : someShapes)
+		{
+			Query(shape, outIds);
+			outOffsets.push_back(static_cast<int>(outIds.size()));
+		}
+
+		return;
+	}
+
+	const size_t batchCount = (someShapes.size() + ourQueryBatchSize - 1) / ourQueryBatchSize;
+	std::vector<BatchResult> results(batchCount);
+	std::latch done(static_cast<std::ptrdiff_t>(batchCount));
+
+	for (size_t batch = 0; batch < batchCount; ++batch)
+	{
+		aThreadPool.AddWork([this, batch, someShapes, &results, &done]()
+		{
+			BatchResult& result = results[batch];
+
+			const size_t end = std::min(someShapes.size(), (batch + 1) * ourQueryBatchSize);
+			for (size_t i = batch * ourQueryBatchSize; i < end; ++i)
+			{
+				const size_t countBefore = result.ids.size();
+				Query(someShapes[i], result.ids);
+				result.counts.push_back(static_cast<int>(result.ids.size() - countBefore));
+			}
+
+			done.count_down();
+		});
+	}
+
+	done.wait();
+
+	outIds.clear();
+	outOffsets.clear();
+	outOffsets.reserve(someShapes.size() + 1);
+	outOffsets.push_back(0);
+
+	for (const BatchResult& result : results)
+	{
+		outIds.insert(outIds.end(), result.ids.begin(), result.ids.end());
+
+		for (int count : result.counts)
+		{
+			outOffsets.push_back(outOffsets.back() + count);
+		}
+	}
+}
+
+template<int Capacity, int MaxDepth>
+inline void QuadTree<Capacity, MaxDepth>::FindNearest(const Vector2f& aPosition, const int aCount, const float aMaxRadius, std::vector<uint32_t>& outIds) const
+{
+	FindNearest(aPosition, aCount, aMaxRadius, outIds, [](const uint32_t) { return true; });
+}
+
+/*
+	Best first search. Nodes are kept in a min heap on the squared distance to their bounds,
+	which is a lower bound for every object center stored below them, and the best objects so far in a max heap.
+*/
+template<int Capacity, int MaxDepth>
+template<class Filter>
+inline void QuadTree<Capacity, MaxDepth>::FindNearest(const Vector2f& aPosition, const int aCount, const float aMaxRadius, std::vector<uint32_t>& outIds, Filter&& aFilter) const
+{
+	struct NodeCandidate
+	{
+		float sqrDistance;
+		int node;
+	};
+
+	struct ObjectCandidate
+	{
+		float sqrDistance;
+		uint32_t id;
+	};
+
+	if (aCount <= 0)
+	{
+		return;
+	}
+
+	auto closer = [](const auto& aLeft, const auto& aRight) { return aLeft.sqrDistance < aRight.sqrDistance; };
+	auto further = [](const auto& aLeft, const auto& aRight) { return aLeft.sqrDistance > aRight.sqrDistance; };
+
+	auto sqrDistanceToNode = [&aPosition](const Node& aNode)
+	{
+		const float dx = std::max(std::abs(aPosition.x - aNode.myPosition.x) - aNode.myHalfWidth, 0.f);
+		const float dy = std::max(std::abs(aPosition.y - aNode.myPosition.y) - aNode.myHalfWidth, 0.f);
+		return dx * dx + dy * dy;
+	};
+
+	std::vector<NodeCandidate> nodes;
+	std::vector<ObjectCandidate> nearest;
+	nearest.reserve(aCount);
+
+	// Shrinks to the distance of the worst kept object once aCount objects are found
+	float sqrSearchRadius = aMaxRadius * aMaxRadius;
+
+	// Objects moved out of the tree by Update are kept in the root, so the root is always visited
+	nodes.push_back({ 0.f, 0 });
+
+	while (!nodes.empty())
+	{
+		std::pop_heap(nodes.begin(), nodes.end(), further);
+		const NodeCandidate candidate = nodes.back();
+		nodes.pop_back();
+
+		if (candidate.sqrDistance > sqrSearchRadius)
+		{
+			break;
+		}
+
+		const Node& node = myNodes[candidate.node];
+
+		ForEachObject(node, [&](const QuadTreeObject& aObject, const QuadTreeHandle)
+		{
+			const float sqrDistance = (aObject.position - aPosition).LengthSqr();
+			if (sqrDistance > sqrSearchRadius || !aFilter(aObject.id))
+			{
+				return;
+			}
+
+			if (static_cast<int>(nearest.size()) == aCount)
+			{
+				std::pop_heap(nearest.begin(), nearest.end(), closer);
+				nearest.pop_back();
+			}
+
+			nearest.push_back({ sqrDistance, aObject.id });
+			std::push_heap(nearest.begin(), nearest.end(), closer);
+
+			if (static_cast<int>(nearest.size()) == aCount)
+			{
+				sqrSearchRadius = nearest.front().sqrDistance;
+			}
+		});
+
+		if (node.IsLeaf())
+		{
+			continue;
+		}
+
+		for (int i = 0; i < 4; ++i)
+		{
+			const int childIndex = node.myFirstChild + i;
+
+			const float sqrDistance = sqrDistanceToNode(myNodes[childIndex]);
+			if (sqrDistance <= sqrSearchRadius)
+			{
+				nodes.push_back({ sqrDistance, childIndex });
+				std::push_heap(nodes.begin(), nodes.end(), further);
+			}
+		}
+	}
+
+	std::sort_heap(nearest.begin(), nearest.end(), closer);
+
+	for (const ObjectCandidate& candidate : nearest)
+	{
+		outIds.push_back(candidate.id);
+	}
+}
+
+template<int Capacity, int MaxDepth>
+template<int Count, class Function>
+inline void QuadTree<Capacity, MaxDepth>::Unroll(Function&& aFunction)
+{
+	[&]<int... Index>(std::integer_sequence<int, Index...>)
+	{
+		(aFunction(Index), ...);
+	}(std::make_integer_sequence<int, Count>());
+}
+
+template<int Capacity, int MaxDepth>
+template<class Function>
+inline void QuadTree<Capacity, MaxDepth>::ForEachObject(const Node& aNode, Function&& aFunction) const
+{
+	const int bucketCount = std::min(aNode.myObjectCount, Capacity);
+
+	Unroll<Capacity>([&](const int aIndex)
+	{
+		if (aIndex < bucketCount)
+		{
+			aFunction(aNode.GetBucketObject(aIndex), aNode.myHandles[aIndex]);
+		}
+	});
+
+	for (int element = aNode.myFirstOverflow; element != -1; element = myElements[element].next)
+	{
+		aFunction(myElements[element].object, myElements[element].handle);
+	}
+}
+
+/*
+	Depth first walk with an explicit stack. Nodes completely inside the shape
+	add their whole subtree without testing the objects. The bucket of a node
+	is tested in one call over the whole arrays, unused entries are ignored afterwards.
+*/
+template<int Capacity, int MaxDepth>
+template<class Shape>
+inline void QuadTree<Capacity, MaxDepth>::Query(const Shape& aShape, std::vector<uint32_t>& outIds) const
+{
+	struct Entry
+	{
+		int node;
+		bool contained;
+	};
+
+	Entry stack[ourTraversalStackSize];
+	int stackSize = 0;
+
+	const Node& root = myNodes[0];
+	if (aShape.Overlaps(root.myPosition, root.myHalfWidth))
+	{
+		stack[stackSize++] = { 0, aShape.Contains(root.myPosition, root.myHalfWidth) };
+	}
+
+	while (stackSize > 0)
+	{
+		const Entry entry = stack[--stackSize];
+		const Node& node = myNodes[entry.node];
+
+		if (node.myObjectCount > 0)
+		{
+			bool overlaps[Capacity];
+			aShape.Overlaps(node.myX, node.myY, node.myHalfWidths, Capacity, overlaps);
+
+			const int bucketCount = std::min(node.myObjectCount, Capacity);
+			for (int i = 0; i < bucketCount; ++i)
+			{
+				if (entry.contained || overlaps[i])
+				{
+					outIds.push_back(node.myIds[i]);
+				}
+			}
+
+			for (int element = node.myFirstOverflow; element != -1; element = myElements[element].next)
+			{
+				const QuadTreeObject& object = myElements[element].object;
+				if (entry.contained || aShape.Overlaps(object.position, object.halfWidth))
+				{
+					outIds.push_back(object.id);
+				}
+			}
+		}
+
+		if (node.IsLeaf())
+		{
+			continue;
+		}
+
+		for (int i = 0; i < 4; ++i)
+		{
+			const int childIndex = node.myFirstChild + i;
+			const Node& child = myNodes[childIndex];
+
+			if (entry.contained)
+			{
+				stack[stackSize++] = { childIndex, true };
+			}
+			else if (aShape.Overlaps(child.myPosition, child.myHalfWidth))
+			{
+				stack[stackSize++] = { childIndex, aShape.Contains(child.myPosition, child.myHalfWidth) };
+			}
+		}
+	}
+}
+
+template<int Capacity, int MaxDepth>
+inline int QuadTree<Capacity, MaxDepth>::AllocateElement(const QuadTreeObject& aObject, const QuadTreeHandle aHandle)
+{
+	if (myFreeElement != -1)
+	{
+		int element = myFreeElement;
+		myFreeElement = myElements[element].next;
+		myElements[element] = { aObject, aHandle, -1 };
+		return element;
+	}
+
+	myElements.push_back({ aObject, aHandle, -1 });
+	return static_cast<int>(myElements.size()) - 1;
+}
+
+template<int Capacity, int MaxDepth>
+inline void QuadTree<Capacity, MaxDepth>::FreeElement(const int aElement)
+{
+	myElements[aElement].handle = -1;
+	myElements[aElement].next = myFreeElement;
+	myFreeElement = aElement;
+}
+
+template<int Capacity, int MaxDepth>
+inline QuadTreeHandle QuadTree<Capacity, MaxDepth>::AllocateSlot()
+{
+	if (myFreeSlot != -1)
+	{
+		QuadTreeHandle handle = myFreeSlot;
+		myFreeSlot = mySlots[handle].nextFree;
+		mySlots[handle] = { -1, -1 };
+		return handle;
+	}
+
+	mySlots.push_back({ -1, -1 });
+	return static_cast<QuadTreeHandle>(mySlots.size()) - 1;
+}
+
+template<int Capacity, int MaxDepth>
+inline void QuadTree<Capacity, MaxDepth>::FreeSlot(const QuadTreeHandle aHandle)
+{
+	mySlots[aHandle] = { -1, myFreeSlot };
+	myFreeSlot = aHandle;
+}
+
+template<int Capacity, int MaxDepth>
+inline int QuadTree<Capacity, MaxDepth>::AllocateChildren()
+{
+	if (myFreeChildren != -1)
+	{
+		int firstChild = myFreeChildren;
+		myFreeChildren = myNodes[firstChild].myFirstChild;
+		return firstChild;
+	}
+
+	int firstChild = static_cast<int>(myNodes.size());
+	myNodes.resize(myNodes.size() + 4);
+	return firstChild;
+}
+
+template<int Capacity, int MaxDepth>
+inline void QuadTree<Capacity, MaxDepth>::FreeChildren(const int aFirstChild)
+{
+	myNodes[aFirstChild].myFirstChild = myFreeChildren;
+	myFreeChildren = aFirstChild;
+}
+
+template<int Capacity, int MaxDepth>
+inline void QuadTree<Capacity, MaxDepth>::LinkObject(const int aNodeIndex, const QuadTreeObject& aObject, const QuadTreeHandle aHandle)
+{
+	Node& node = myNodes[aNodeIndex];
+
+	if (node.myObjectCount < Capacity)
+	{
+		node.SetBucketObject(node.myObjectCount, aObject, aHandle);
+	}
+	else
+	{
+		int element = AllocateElement(aObject, aHandle);
+		myElements[element].next = node.myFirstOverflow;
+		node.myFirstOverflow = element;
+	}
+
+	++node.myObjectCount;
+}
+
+template<int Capacity, int MaxDepth>
+inline QuadTreeObject QuadTree<Capacity, MaxDepth>::UnlinkObject(const int aNodeIndex, const QuadTreeHandle aHandle)
+{
+	Node& node = myNodes[aNodeIndex];
+	const int bucketCount = std::min(node.myObjectCount, Capacity);
+
+	int bucketIndex = -1;
+	Unroll<Capacity>([&](const int aIndex)
+	{
+		if (aIndex < bucketCount && node.myHandles[aIndex] == aHandle)
+		{
+			bucketIndex = aIndex;
+		}
+	});
+
+	QuadTreeObject object;
+
+	if (bucketIndex != -1)
+	{
+		object = node.GetBucketObject(bucketIndex);
+
+		// Fill the hole with an overflow object so the bucket stays full while there is overflow
+		if (node.myFirstOverflow != -1)
+		{
+			const int element = node.myFirstOverflow;
+			node.SetBucketObject(bucketIndex, myElements[element].object, myElements[element].handle);
+			node.myFirstOverflow = myElements[element].next;
+			FreeElement(element);
+		}
+		else
+		{
+			node.SetBucketObject(bucketIndex, node.GetBucketObject(bucketCount - 1), node.myHandles[bucketCount - 1]);
+		}
+	}
+	else
+	{
+		int* link = &node.myFirstOverflow;
+		while (myElements[*link].handle != aHandle)
+		{
+			link = &myElements[*link].next;
+		}
+
+		const int element = *link;
+		object = myElements[element].object;
+		*link = myElements[element].next;
+		FreeElement(element);
+	}
+
+	--node.myObjectCount;
+
+	return object;
+}
+
+template<int Capacity, int MaxDepth>
+inline int QuadTree<Capacity, MaxDepth>::FindChild(const Node& aNode, const QuadTreeObject& aObject) const
+{
+	for (int i = 0; i < 4; ++i)
+	{
+		if (myNodes[aNode.myFirstChild + i].Inside(aObject))
+		{
+			return aNode.myFirstChild + i;
+		}
+	}
+
+	return -1;
+}
+
+template<int Capacity, int MaxDepth>
+inline int QuadTree<Capacity, MaxDepth>::FindInsertNode(const int aStartNode, const QuadTreeObject& aObject) const
+{
+	int nodeIndex = aStartNode;
+	while (!myNodes[nodeIndex].IsLeaf())
+	{
+		int child = FindChild(myNodes[nodeIndex], aObject);
+		if (child == -1)
+		{
+			break;
+		}
+
+		nodeIndex = child;
+	}
+
+	return nodeIndex;
+}
+
+template<int Capacity, int MaxDepth>
+inline bool QuadTree<Capacity, MaxDepth>::ShouldSplit(const Node& aNode) const
+{
+	return aNode.IsLeaf() && aNode.myObjectCount > Capacity && aNode.myDepth < MaxDepth;
+}
+
+template<int Capacity, int MaxDepth>
+inline void QuadTree<Capacity, MaxDepth>::CreateChildren(const int aNodeIndex)
+{
+	// Allocating can reallocate the node array, so only hold references after it
+	const int firstChild = AllocateChildren();
+	InitChildren(aNodeIndex, firstChild);
+
+	// Take the objects out of the node and link them again, objects that do not fit in any child stay in this node
+	const Node bucket = myNodes[aNodeIndex];
+	const int bucketCount = std::min(bucket.myObjectCount, Capacity);
+
+	myNodes[aNodeIndex].myFirstOverflow = -1;
+	myNodes[aNodeIndex].myObjectCount = 0;
+
+	auto relink = [&](const QuadTreeObject& aObject, const QuadTreeHandle aHandle)
+	{
+		int child = FindChild(myNodes[aNodeIndex], aObject);
+		int target = child != -1 ? child : aNodeIndex;
+
+		LinkObject(target, aObject, aHandle);
+		mySlots[aHandle].node = target;
+	};
+
+	for (int i = 0; i < bucketCount; ++i)
+	{
+		relink(bucket.GetBucketObject(i), bucket.myHandles[i]);
+	}
+
+	int element = bucket.myFirstOverflow;
+	while (element != -1)
+	{
+		const QuadTreeElement overflow = myElements[element];
+
+		FreeElement(element);
+		relink(overflow.object, overflow.handle);
+
+		element = overflow.next;
+	}
+
+	for (int i = 0; i < 4; ++i)
+	{
+		if (ShouldSplit(myNodes[firstChild + i]))
+		{
+			CreateChildren(firstChild + i);
+		}
+	}
+}
+
+template<int Capacity, int MaxDepth>
+inline void QuadTree<Capacity, MaxDepth>::InitChildren(const int aNodeIndex, const int aFirstChild)
+{
+	const Vector2f position = myNodes[aNodeIndex].myPosition;
+	const float halfWidthChildren = myNodes[aNodeIndex].myHalfWidth * 0.5f;
+	const int depthChildren = myNodes[aNodeIndex].myDepth + 1;
+
+	for (int i = 0; i < 4; ++i)
+	{
+		Node& child = myNodes[aFirstChild + i];
+		child = Node();
+		child.myHalfWidth = halfWidthChildren;
+		child.myParent = aNodeIndex;
+		child.myDepth = depthChildren;
+	}
+
+	myNodes[aFirstChild + 0].myPosition = { position.x - halfWidthChildren, position.y + halfWidthChildren };
+	myNodes[aFirstChild + 1].myPosition = { position.x + halfWidthChildren, position.y + halfWidthChildren };
+	myNodes[aFirstChild + 2].myPosition = { position.x + halfWidthChildren, position.y - halfWidthChildren };
+	myNodes[aFirstChild + 3].myPosition = { position.x - halfWidthChildren, position.y - halfWidthChildren };
+
+	myNodes[aNodeIndex].myFirstChild = aFirstChild;
+}
+
+template<int Capacity, int MaxDepth>
+inline void QuadTree<Capacity, MaxDepth>::TryCollapse(const int aNodeIndex)
+{
+	int nodeIndex = myNodes[aNodeIndex].IsLeaf() ? myNodes[aNodeIndex].myParent : aNodeIndex;
+
+	while (nodeIndex != -1 && Collapse(nodeIndex))
+	{
+		nodeIndex = myNodes[nodeIndex].myParent;
+	}
+}
+
+template<int Capacity, int MaxDepth>
+inline bool QuadTree<Capacity, MaxDepth>::Collapse(const int aNodeIndex)
+{
+	const int firstChild = myNodes[aNodeIndex].myFirstChild;
+	int objectCount = myNodes[aNodeIndex].myObjectCount;
+
+	for (int i = 0; i < 4; ++i)
+	{
+		const Node& child = myNodes[firstChild + i];
+		if (!child.IsLeaf())
+		{
+			return false;
+		}
+
+		objectCount += child.myObjectCount;
+	}
+
+	if (objectCount > Capacity)
+	{
+		return false;
+	}
+
+	// Everything fits in one bucket, so none of the children have overflow
+	for (int i = 0; i < 4; ++i)
+	{
+		const Node& child = myNodes[firstChild + i];
+		for (int j = 0; j < child.myObjectCount; ++j)
+		{
+			LinkObject(aNodeIndex, child.GetBucketObject(j), child.myHandles[j]);
+			mySlots[child.myHandles[j]].node = aNodeIndex;
+		}
+	}
+
+	myNodes[aNodeIndex].myFirstChild = -1;
+	FreeChildren(firstChild);
+
+	return true;
+}
+
+template<int Capacity, int MaxDepth>
+inline void QuadTree<Capacity, MaxDepth>::ComputeSortKeys(std::span<const QuadTreeObject> someObjects)
+{
+	const Node& root = myNodes[0];
+	const float minX = root.myPosition.x - root.myHalfWidth;
+	const float minY = root.myPosition.y - root.myHalfWidth;
+	const float inverseSize = 1.f / (root.myHalfWidth * 2.f);
+
+	mySortKeys.clear();
+	for (size_t i = 0; i < someObjects.size(); ++i)
+	{
+		const QuadTreeObject& object = someObjects[i];
+		if (!root.Inside(object))
+		{
+			continue;
+		}
+
+		uint64_t key = MortonKey((object.position.x - minX) * inverseSize, (object.position.y - minY) * inverseSize);
+		mySortKeys.push_back((key << 32) | static_cast<uint64_t>(i));
+	}
+
+	RadixSort(mySortKeys, mySortScratch);
+}
+
+template<int Capacity, int MaxDepth>
+inline void QuadTree<Capacity, MaxDepth>::BuildNodes(std::span<const QuadTreeObject> someObjects, std::span<uint64_t> someKeys, std::vector<BuildRange>& aStack,
+	const int aDeferDepth, const size_t aDeferObjects, std::vector<BuildRange>* outDeferred)
+{
+	// Maps the two Morton bits of a level (x in bit 0, y in bit 1) to the child index
+	constexpr int quadrantToChild[4] = { 3, 2, 0, 1 };
+
+	auto linkKey = [&](const int aNodeIndex, const uint64_t aKey)
+	{
+		const QuadTreeHandle handle = static_cast<QuadTreeHandle>(aKey & 0xffffffff);
+		LinkObject(aNodeIndex, someObjects[handle], handle);
+	};
+
+	while (!aStack.empty())
+	{
+		const BuildRange range = aStack.back();
+		aStack.pop_back();
+
+		const size_t objectCount = range.end - range.begin;
+
+		if (objectCount <= static_cast<size_t>(Capacity) || range.depth == MaxDepth)
+		{
+			for (size_t i = range.begin; i < range.end; ++i)
+			{
+				linkKey(range.node, someKeys[i]);
+			}
+
+			continue;
+		}
+
+		if (outDeferred && range.depth >= aDeferDepth && objectCount > aDeferObjects)
+		{
+			outDeferred->push_back(range);
+			continue;
+		}
+
+		const int firstChild = AllocateChildren();
+		InitChildren(range.node, firstChild);
+
+		// The keys share every bit above this level, so each quadrant is one contiguous run
+		const int shift = 2 * (ourMortonBits - 1 - range.depth) + 32;
+		size_t begin = range.begin;
+
+		for (int quadrant = 0; quadrant < 4; ++quadrant)
+		{
+			const int child = firstChild + quadrantToChild[quadrant];
+
+			// Objects overlapping the child's edges stay in this node, the rest are compacted in Morton order
+			size_t fitEnd = begin;
+			size_t end = begin;
+
+			for (; end < range.end && static_cast<int>((someKeys[end] >> shift) & 3) == quadrant; ++end)
+			{
+				const uint64_t key = someKeys[end];
+				if (myNodes[child].Inside(someObjects[key & 0xffffffff]))
+				{
+					someKeys[fitEnd++] = key;
+				}
+				else
+				{
+					linkKey(range.node, key);
+				}
+			}
+
+			aStack.push_back({ child, range.depth + 1, begin, fitEnd });
+			begin = end;
+		}
+	}
+}
+
+template<int Capacity, int MaxDepth>
+inline void QuadTree<Capacity, MaxDepth>::Splice(const int aNodeIndex, const QuadTree& aSubtree)
+{
+	// Subtree node i > 0 ends up at nodeOffset + i, child blocks stay adjacent
+	const int nodeOffset = static_cast<int>(myNodes.size()) - 1;
+	const int elementOffset = static_cast<int>(myElements.size());
+
+	auto mapNode = [&](const int aIndex) { return aIndex <= 0 ? (aIndex == 0 ? aNodeIndex : -1) : aIndex + nodeOffset; };
+	auto mapElement = [&](const int aIndex) { return aIndex == -1 ? -1 : aIndex + elementOffset; };
+
+	// The subtree root is a copy of this node, only the links and the bucket differ
+	const int parent = myNodes[aNodeIndex].myParent;
+
+	Node& node = myNodes[aNodeIndex];
+	node = aSubtree.myNodes[0];
+	node.myParent = parent;
+	node.myFirstChild = mapNode(node.myFirstChild);
+	node.myFirstOverflow = mapElement(node.myFirstOverflow);
+
+	for (size_t i = 1; i < aSubtree.myNodes.size(); ++i)
+	{
+		Node subtreeNode = aSubtree.myNodes[i];
+		subtreeNode.myParent = mapNode(subtreeNode.myParent);
+		subtreeNode.myFirstChild = mapNode(subtreeNode.myFirstChild);
+		subtreeNode.myFirstOverflow = mapElement(subtreeNode.myFirstOverflow);
+
+		myNodes.push_back(subtreeNode);
+	}
+
+	for (QuadTreeElement element : aSubtree.myElements)
+	{
+		element.next = mapElement(element.next);
+		myElements.push_back(element);
+	}
+}
+
+template<int Capacity, int MaxDepth>
+inline void QuadTree<Capacity, MaxDepth>::AssignSlots(const size_t aObjectCount)
+{
+	// Right after a build no nodes are freed, so every node in the array is part of the tree.
+	// Objects outside the root get a slot that is not in the tree and not on the free list.
+	mySlots.assign(aObjectCount, { -1, -1 });
+
+	for (int nodeIndex = 0; nodeIndex < static_cast<int>(myNodes.size()); ++nodeIndex)
+	{
+		ForEachObject(myNodes[nodeIndex], [&](const QuadTreeObject&, const QuadTreeHandle aHandle)
+		{
+			mySlots[aHandle].node = nodeIndex;
+		});
+	}
+}
+
+template<int Capacity, int MaxDepth>
+inline uint32_t QuadTree<Capacity, MaxDepth>::SpreadBits(uint32_t aValue)
+{
+	aValue &= 0x0000ffff;
+	aValue = (aValue | (aValue << 8)) & 0x00ff00ff;
+	aValue = (aValue | (aValue << 4)) & 0x0f0f0f0f;
+	aValue = (aValue | (aValue << 2)) & 0x33333333;
+	aValue = (aValue | (aValue << 1)) & 0x55555555;
+	return aValue;
+}
+
+template<int Capacity, int MaxDepth>
+inline uint32_t QuadTree<Capacity, MaxDepth>::MortonKey(const float aX, const float aY)
+{
+	// Scaled by the cell count so the cell edges fall on the quadrant splits, 1 is clamped into the last cell
+	constexpr float cellCount = static_cast<float>(1 << ourMortonBits);
+	constexpr uint32_t lastCell = (1 << ourMortonBits) - 1;
+
+	uint32_t x = std::min(static_cast<uint32_t>(std::clamp(aX, 0.f, 1.f) * cellCount), lastCell);
+	uint32_t y = std::min(static_cast<uint32_t>(std::clamp(aY, 0.f, 1.f) * cellCount), lastCell);
+
+	return SpreadBits(x) | (SpreadBits(y) << 1);
+}
+
+template<int Capacity, int MaxDepth>
+inline void QuadTree<Capacity, MaxDepth>::RadixSort(std::vector<uint64_t>& someKeys, std::vector<uint64_t>& someScratch)
+{
+	someScratch.resize(someKeys.size());
+
+	for (int shift = 32; shift < 64; shift += 8)
+	{
+		size_t offsets[257] = {};
+		for (uint64_t key : someKeys)
+		{
+			++offsets[((key >> shift) & 0xff) + 1];
+		}
+
+		for (int i = 0; i < 256; ++i)
+		{
+			offsets[i + 1] += offsets[i];
+		}
+
+		for (uint64_t key : someKeys)
+		{
+			someScratch[offsets[(key >> shift) & 0xff]++] = key;
+		}
 
-};
\ No newline at end of file
+		someKeys.swap(someScratch);
+	}
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "FSMState.h"
+
+#include <span>
+#include <cstdint>
+
+/*
+	State for BatchedStateMachine. One state object is shared by every entity in it, so the calls name the entities
+	and the data per entity is kept by the state. There are no defaults, calling Enter, Update or Exit once per entity
+	would run code written for one state machine many times on the shared state.
+*/
+class BatchedFSMState : public FSMState
+{
+	public:
+		// aEntity is the index the state machine gave the entity
+		virtual void EnterEntity(const uint32_t aEntity) = 0;
+		virtual void ExitEntity(const uint32_t aEntity) = 0;
+
+		// Every entity in the state at once, one call per state per frame instead of one per entity
+		virtual void UpdateBatch(std::span<const uint32_t> someEntities, const float aDeltaTime) = 0;
+
+	private:
+		// BatchedStateMachine only makes the calls above
+		void Update(const float /*aDeltaTime*/) override { __noop; }
+};
@@ -0,0 +1,176 @@
+#include "BatchedStateMachine.h"
+
+#include "BatchedFSMState.h"
+#include "FSMTransition.h"
+
+#include <assert.h>
+
+BatchedStateMachine::~BatchedStateMachine()
+{
+	for (uint32_t entity = 0; entity < myEntities.size(); ++entity)
+	{
+		if (myEntities[entity] != ourNoState)
+		{
+			myStates[myEntities[entity]]->ExitEntity(entity);
+		}
+	}
+
+	for (auto* state : myStates)
+	{
+		delete state;
+	}
+}
+
+FSMStateId BatchedStateMachine::AddState(BatchedFSMState& aState)
+{
+	assert(myStates.size() < ourNoState && "Too many states for FSMStateId");
+
+	const FSMStateId stateId = static_cast<FSMStateId>(myStates.size());
+	myStates.emplace_back(&aState);
+	myStateIds[&aState] = stateId;
+
+	return stateId;
+}
+
+FSMStateId BatchedStateMachine::GetStateId(const FSMState& aState) const
+{
+	auto found = myStateIds.find(&aState);
+	assert(found != myStateIds.end() && "State was not added to the state machine");
+
+	return found->second;
+}
+
+void BatchedStateMachine::Init(const uint32_t aEntityCount, const FSMStateId aInitialState)
+{
+	assert(myEntities.empty() && "State machine already has entities");
+
+	BatchedFSMState& state = *myStates[aInitialState];
+	myEntities.assign(aEntityCount, aInitialState);
+
+	for (uint32_t entity = 0; entity < aEntityCount; ++entity)
+	{
+		state.EnterEntity(entity);
+	}
+}
+
+uint32_t BatchedStateMachine::AddEntity(const FSMStateId aState)
+{
+	assert(aState < myStates.size() && "State was not added to the state machine");
+
+	uint32_t entity;
+	if (!myFreeEntities.empty())
+	{
+		entity = myFreeEntities.back();
+		myFreeEntities.pop_back();
+		myEntities[entity] = aState;
+	}
+	else
+	{
+		entity = static_cast<uint32_t>(myEntities.size());
+		myEntities.push_back(aState);
+	}
+
+	myStates[aState]->EnterEntity(entity);
+
+	return entity;
+}
+
+void BatchedStateMachine::RemoveEntity(const uint32_t aEntity)
+{
+	assert(aEntity < myEntities.size() && myEntities[aEntity] != ourNoState && "Removing an entity that is not in the state machine");
+
+	myStates[myEntities[aEntity]]->ExitEntity(aEntity);
+
+	myEntities[aEntity] = ourNoState;
+	myFreeEntities.push_back(aEntity);
+}
+
+void BatchedStateMachine::UpdateAll(const float aDeltaTime)
+{
+	const size_t stateCount = myStates.size();
+
+	// Counting sort, the entities of a state keep their order and removed entities are left out
+	myBatchOffsets.assign(stateCount + 1, 0);
+	for (const FSMStateId stateId : myEntities)
+	{
+		if (stateId != ourNoState)
+		{
+			++myBatchOffsets[stateId + 1];
+		}
+	}
+
+	for (size_t stateId = 0; stateId < stateCount; ++stateId)
+	{
+		myBatchOffsets[stateId + 1] += myBatchOffsets[stateId];
+	}
+
+	myBatchEnds.assign(myBatchOffsets.begin(), myBatchOffsets.end() - 1);
+	myBatches.resize(myEntities.size());
+	myValid.resize(myEntities.size());
+
+	for (uint32_t entity = 0; entity < myEntities.size(); ++entity)
+	{
+		if (myEntities[entity] != ourNoState)
+		{
+			myBatches[myBatchEnds[myEntities[entity]]++] = entity;
+		}
+	}
+
+	for (size_t stateId = 0; stateId < stateCount; ++stateId)
+	{
+		uint32_t* batch = myBatches.data() + myBatchOffsets[stateId];
+		size_t count = myBatchOffsets[stateId + 1] - myBatchOffsets[stateId];
+
+		if (count == 0)
+		{
+			continue;
+		}
+
+		BatchedFSMState& state = *myStates[stateId];
+
+		for (auto& transition : state.GetTransitions())
+		{
+			if (count == 0)
+			{
+				break;
+			}
+
+			transition->EvaluateBatch(std::span<const uint32_t>(batch, count), std::span<uint8_t>(myValid.data(), count));
+
+			// Entities that leave are taken out of the batch so the later transitions and the update skip them
+			BatchedFSMState* nextState = nullptr;
+			FSMStateId nextStateId = 0;
+			size_t keptCount = 0;
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				const uint32_t entity = batch[i];
+				if (!myValid[i])
+				{
+					batch[keptCount++] = entity;
+					continue;
+				}
+
+				if (!nextState)
+				{
+					nextStateId = GetStateId(*transition->GetState());
+					nextState = myStates[nextStateId];
+				}
+
+				state.ExitEntity(entity);
+
+				myEntities[entity] = nextStateId;
+
+				transition->OnEntityTransition(entity);
+				nextState->EnterEntity(entity);
+			}
+
+			count = keptCount;
+		}
+
+		if (count > 0)
+		{
+			state.UpdateBatch(std::span<const uint32_t>(batch, count), aDeltaTime);
+		}
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+
+class FSMState;
+class BatchedFSMState;
+
+// Index of a state in a BatchedStateMachine, all an entity keeps of its state
+using FSMStateId = uint16_t;
+
+/*
+	One set of states shared by many entities. Each entity is only the id of its current state, and UpdateAll
+	groups the entities by state so every transition and state is called once per batch instead of once per entity.
+	States derive from BatchedFSMState, whose calls give them the entities, and lead on with the same FSMTransitions
+	as FiniteStateMachine. OnTransition is not called, the per entity OnEntityTransition is, and the default EvaluateBatch
+	asks IsValid once for the whole batch. A transition is expected to lead to the same state for the whole batch.
+	The state machine owns the state ids of the entities, and the entities still in it are exited on destruction
+	like FiniteStateMachine exits its current state.
+*/
+class BatchedStateMachine
+{
+	public:
+		// State id of an entity index that was removed and not reused yet
+		static constexpr FSMStateId ourNoState = UINT16_MAX;
+
+		BatchedStateMachine() = default;
+		virtual ~BatchedStateMachine();
+
+		// Takes ownership like FiniteStateMachine::AddState, the id is what entities store
+		FSMStateId AddState(BatchedFSMState& aState);
+		FSMStateId GetStateId(const FSMState& aState) const;
+
+		// Adds entities 0 to aEntityCount - 1 in the state and enters it
+		void Init(const uint32_t aEntityCount, const FSMStateId aInitialState);
+
+		// Enters the state, returns the index of the entity which is what the batch calls are given.
+		// Removed indices are reused before new ones are added at the end.
+		uint32_t AddEntity(const FSMStateId aState);
+
+		// Exits the entity's state, its index is free for AddEntity
+		void RemoveEntity(const uint32_t aEntity);
+
+		// Same order as FiniteStateMachine::Update, an entity that changes state is not updated until the next call
+		void UpdateAll(const float aDeltaTime);
+
+		inline BatchedFSMState& GetState(const FSMStateId aStateId) const { return *myStates[aStateId]; }
+		inline size_t GetStateCount() const { return myStates.size(); }
+
+		// ourNoState for a removed entity
+		inline FSMStateId GetEntityState(const uint32_t aEntity) const { return myEntities[aEntity]; }
+
+		// One past the highest entity index, removed entities included
+		inline uint32_t GetEntityCount() const { return static_cast<uint32_t>(myEntities.size()); }
+
+	private:
+		std::vector<BatchedFSMState*> myStates;
+		std::unordered_map<const FSMState*, FSMStateId> myStateIds;
+
+		// State id per entity index
+		std::vector<FSMStateId> myEntities;
+		std::vector<uint32_t> myFreeEntities;
+
+		// Entities sorted by state, the batch of a state starts at its offset
+		std::vector<uint32_t> myBatches;
+		std::vector<uint32_t> myBatchOffsets;
+		std::vector<uint32_t> myBatchEnds;
+		std::vector<uint8_t> myValid;
+};
@@ -6,6 +6,8 @@ class FSMTransition;
 class FSMState
 {
 	public:
+		// The state machines delete their states through this class
+		virtual ~FSMState() = default;
 	
 		virtual void Enter() { __noop;  }
 		virtual void Update(const float aDeltaTime) = 0;
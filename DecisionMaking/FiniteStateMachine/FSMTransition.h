@@ -1,5 +1,9 @@
 #pragma once
 
+#include <span>
+#include <cstdint>
+#include <algorithm>
+
 class FSMState;
 class FSMTransition
 {
@@ -7,4 +11,14 @@ class FSMTransition
 		virtual bool IsValid() = 0;
 		virtual FSMState* GetState() = 0;
 		virtual void OnTransition() { __noop; }
+
+		// Used by BatchedStateMachine, outValid[i] tells whether someEntities[i] takes the transition.
+		// The default asks IsValid once for the whole batch, override it when the answer depends on the entity.
+		virtual void EvaluateBatch(std::span<const uint32_t> /*someEntities*/, std::span<uint8_t> outValid)
+		{
+			std::fill(outValid.begin(), outValid.end(), static_cast<uint8_t>(IsValid()));
+		}
+
+		// Called by BatchedStateMachine instead of OnTransition, which would run once per entity on the shared transition
+		virtual void OnEntityTransition(const uint32_t /*aEntity*/) { __noop; }
 };
\ No newline at end of file
@@ -26,6 +26,11 @@ ThreadPool::~ThreadPool()
 void ThreadPool::AddWork(std::function<void()> aFunction)
 {
 	myWorkQueue.Push(aFunction);
+
+	// Taking the lock makes sure a worker is not between checking the queue and starting to wait, which would miss the notify
+	{
+		std::lock_guard<std::mutex> lock(myLock);
+	}
 	myConditionalQueueLock.notify_one();
 }
 
@@ -44,6 +49,20 @@ void ThreadPool::Join()
 	myThreads.clear();
 }
 
+bool ThreadPool::IsWorkerThread() const
+{
+	const std::thread::id id = std::this_thread::get_id();
+	for (const auto& thread : myThreads)
+	{
+		if (thread.get_id() == id)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
 // should have something that says that there exist a work in the queue before we wake it up
 void ThreadPool::DoWork()
 {
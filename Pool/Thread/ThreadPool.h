@@ -4,7 +4,9 @@
 
 #include <atomic>
 #include <thread>
+#include <vector>
 #include <functional>
+#include <condition_variable>
 
 
 class ThreadPool
@@ -21,6 +23,12 @@ class ThreadPool
 		inline const size_t GetQueueSize() const { return myWorkQueue.Size(); }
 		inline const size_t Size() const { return myThreads.size(); }
 
+		// Work added after Terminate is never run
+		inline bool IsTerminated() const { return myDone; }
+
+		// True on the threads of this pool, which must not wait for work they added since it may be queued behind them
+		bool IsWorkerThread() const;
+
 	private:
 		void DoWork();
 
@@ -14,7 +14,7 @@ class ThreadSafeQueue
 
 	private:
 		std::queue<T> myQueue;
-		std::mutex myLock;
+		mutable std::mutex myLock;
 };
 
 template<class T>
@@ -49,6 +49,12 @@ inline const bool ThreadSafeQueue<T>::TryPop(T& outValue)
 template<class T>
 inline const size_t ThreadSafeQueue<T>::Size() const
 {
-	return myQueue.size();
+	myLock.lock();
+
+	size_t size = myQueue.size();
+
+	myLock.unlock();
+
+	return size;
 }
 